@@ -13,6 +13,9 @@
 // <shared_mutex>  : 提供共享互斥鎖 (std::shared_mutex)，支援共享與獨占鎖定（C++17）.
 //                    Provides shared mutex supporting shared and exclusive locking (C++17).
 //
+// <condition_variable> : 提供條件變數，讓執行緒等待某個條件成立（例如範圍鎖被釋放）.
+//                    Provides condition variables for waiting until a condition holds.
+//
 // <chrono>        : 提供計時與時間間隔功能，例如 sleep_for、sleep_until.
 //                    Provides timing and duration functionalities.
 //
@@ -24,15 +27,41 @@
 //
 // <iomanip>       : 提供格式化輸出功能，例如 std::setw、std::setprecision.
 //                    Provides formatting manipulators.
+//
+// <random>        : 提供亂數產生器，用於隨機選擇轉帳的來源與目的索引.
+//                    Provides random number engines for picking transfer indices.
+//
+// <algorithm>     : 提供排序與去重等演算法，例如 std::sort、std::unique.
+//                    Provides algorithms such as std::sort and std::unique.
+//
+// <utility>       : 提供 std::pair 等工具類別.
+//                    Provides utility types such as std::pair.
+//
+// <array>         : 提供固定大小陣列 std::array，用於快照表的區塊.
+//                    Provides fixed-size std::array used by snapshot chunks.
+//
+// <string>        : 提供 std::string 與 std::to_string，用於組合輸出標籤.
+//                    Provides std::string and std::to_string for building output labels.
 //------------------------------------------------------------------------------
 #include <iostream>
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
 #include <chrono>
 #include <vector>
 #include <atomic>
 #include <iomanip>
+#include <random>
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <array>
+
+// RCU 設定物件（定義於後方 RCU 區段），testLockPerformance 將其視為一種「鎖型別」
+// RCU-published configuration (defined in the RCU section below), usable as a "lock type" in testLockPerformance
+struct AppConfig;
+template<typename T> class RcuCell;
 
 //===================================================================
 // 測試函式 / Testing Function
@@ -106,6 +135,32 @@ double testLockPerformance(MutexType& mtx, int numThreads, int iterations, bool
                     }
                 }
             }
+            // 編譯期檢查 MutexType 是否為 RCU 發布的設定物件
+            else if constexpr (std::is_same<MutexType, RcuCell<AppConfig>>::value)
+            {
+                // 讀取：不上鎖，直接取得目前發布版本的指標
+                // 寫入：複製目前版本、修改後發布新版本，舊版本延後回收
+                for (int i = 0; i < iterations; ++i)
+                {
+                    if (readOnly)
+                    {
+                        auto config = mtx.read();
+                        if (ioBound)
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                        volatile long long dummy = config->version;
+                        (void)dummy;
+                    }
+                    else
+                    {
+                        mtx.update([&](auto& config)
+                        {
+                            if (ioBound)
+                                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                            ++config.version;
+                        });
+                    }
+                }
+            }
             else {
                 // 對於其他 mutex 類型（例如 std::mutex），僅支援獨占鎖定
                 for (int i = 0; i < iterations; ++i)
@@ -290,108 +345,1397 @@ double testFineGrainedVectorPerformanceShared(int numThreads, int iterations, in
     return std::chrono::duration<double>(endTime - startTime).count();
 }
 
-int main()
+//===================================================================
+// 軟體交易記憶體 / Software Transactional Memory (TL2-style)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 交易偵測到衝突時拋出，由 atomically() 捕捉後重新執行整筆交易
+/// Thrown when a transaction detects a conflict; atomically() catches it and retries.
+struct TransactionAbort {};
+
+/// -----------------------------------------------------------------
+/// TL2 風格的字組式 STM，保護一個 int 向量
+///   全域版本時鐘 (global version clock)：每次成功的寫入交易提交時遞增
+///   條帶版本鎖 (versioned stripe lock)：bit 0 為鎖定位元，其餘位元為最後提交的版本號
+///   讀取集合 / 寫入集合：讀取時記錄條帶，寫入先暫存，提交時才鎖定並寫回
+/// 使用者只需描述「要讀寫哪些元素」，不必自行規劃多把鎖的取得順序
+/// Word-based TL2 STM over a vector<int>: callers describe what to read/write,
+/// the STM takes care of locking order, validation and retry.
+class Tl2Stm
 {
-    int numThreads = 8;         // 執行緒數量 / Number of threads
-    int iterations = 100000;    // 計算密集模式（寫入）的迭代次數 / Iterations per thread for compute-bound write
-    int ioIterations = 1000;    // I/O 密集模式（寫入）的迭代次數 / Iterations per thread for I/O-bound write
-    int readIterations = 100000;  // 計算密集模式（讀取）的迭代次數 / Iterations per thread for compute-bound read
-    int ioReadIterations = 1000;  // I/O 密集模式（讀取）的迭代次數 / Iterations per thread for I/O-bound read
+public:
+    class Transaction;
 
-    // 建立兩種鎖：std::mutex（僅支援獨占）與 std::shared_mutex（支援共享讀取）
-    // Create two mutex types: std::mutex (exclusive only) and std::shared_mutex (supports shared locking)
-    std::mutex mtx;
-    std::shared_mutex shrdMtx;
+    Tl2Stm(int dataSize, int stripeCount, int initialValue)
+        : data_(dataSize), stripes_(stripeCount)
+    {
+        for (auto& value : data_)
+            value.store(initialValue, std::memory_order_relaxed);
+    }
 
-    // 輸出格式設定 / Output formatting settings
-    const int widthLabel = 50;
-    const int widthTime  = 12;
-    std::cout << std::fixed << std::setprecision(6);
+    /// 執行交易直到成功提交；fn 可能因衝突被重新執行多次，因此不應在交易外產生副作用
+    /// 不支援巢狀交易
+    template<typename Func>
+    void atomically(Func&& fn);
 
-    // ------ 寫入操作 測試 / Writing Operation Tests (Exclusive Lock Tests) ------
-    std::cout << "\n=== Writing Operation (Exclusive Lock) Tests / 寫入操作 (獨占鎖) 測試 ===\n\n";
+    /// 非交易式讀取，只在沒有交易執行時（例如測試結束後驗證）使用
+    int peek(int index) const { return data_[index].load(std::memory_order_relaxed); }
 
-    // ------ 計算密集模式（寫入，lock_guard） / Compute-bound Write using lock_guard
-    double timeMutexWrite = testLockPerformance(mtx, numThreads, iterations, false, false, false);
-    double timeSharedWrite = testLockPerformance(shrdMtx, numThreads, iterations, false, false, false);
-    std::cout << std::setw(widthLabel) << "Compute-bound Write (lock_guard) / 計算密集 (寫入, lock_guard):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexWrite << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedWrite << " sec\n\n";
+    long long abortCount() const { return aborts_.load(std::memory_order_relaxed); }
 
-    // ------ 計算密集模式（寫入，unique_lock） / Compute-bound Write using unique_lock ------
-    double timeMutexWriteUL = testLockPerformance(mtx, numThreads, iterations, false, true, false);
-    double timeSharedWriteUL = testLockPerformance(shrdMtx, numThreads, iterations, false, true, false);
-    std::cout << std::setw(widthLabel) << "Compute-bound Write (unique_lock) / 計算密集 (寫入, unique_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexWriteUL << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedWriteUL << " sec\n\n";
+private:
+    /// 交易的讀寫紀錄，每個執行緒重複使用同一份以避免每筆交易都配置記憶體
+    struct TransactionLog
+    {
+        std::vector<int> readStripes;                                   // 讀取集合（條帶編號）
+        std::vector<std::pair<int, int>> writes;                        // 寫入集合（索引, 新值）
+        std::vector<std::pair<int, unsigned long long>> lockedStripes;  // 提交時已鎖定的條帶與鎖定前的值
+    };
 
-    // ------ I/O 密集模式（寫入，lock_guard） / I/O-bound Write using lock_guard ------
-    double timeMutexIOWrite = testLockPerformance(mtx, numThreads, ioIterations, true, false, false);
-    double timeSharedIOWrite = testLockPerformance(shrdMtx, numThreads, ioIterations, true, false, false);
-    std::cout << std::setw(widthLabel) << "I/O-bound Write (lock_guard) / I/O密集 (寫入, lock_guard):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOWrite << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedIOWrite << " sec\n\n";
+    int stripeOf(int index) const { return index % static_cast<int>(stripes_.size()); }
 
-    // ------ I/O 密集模式（寫入，unique_lock） / I/O-bound Write using unique_lock ------
-    double timeMutexIOWriteUL = testLockPerformance(mtx, numThreads, ioIterations, true, true, false);
-    double timeSharedIOWriteUL = testLockPerformance(shrdMtx, numThreads, ioIterations, true, true, false);
-    std::cout << std::setw(widthLabel) << "I/O-bound Write (unique_lock) / I/O密集 (寫入, unique_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOWriteUL << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedIOWriteUL << " sec\n";
+    std::atomic<unsigned long long> clock_{0};                  // 全域版本時鐘
+    std::vector<std::atomic<int>> data_;                        // 受保護的資料
+    std::vector<std::atomic<unsigned long long>> stripes_;      // 條帶版本鎖
+    std::atomic<long long> aborts_{0};                          // 中止（重試）次數統計
+};
 
-    // ------ 讀取操作 測試 / Reading Operation Tests (Shared Lock Tests) ------
-    std::cout << "\n=== Reading Operation (Shared Lock) Tests / 讀取操作 (共享鎖) 測試 ===\n\n";
+/// -----------------------------------------------------------------
+/// 單筆交易：read() / write() 在交易內存取資料，commit() 由 atomically() 呼叫
+class Tl2Stm::Transaction
+{
+public:
+    Transaction(Tl2Stm& stm, TransactionLog& log) : stm_(stm), log_(log) {}
 
-    // ------ 計算密集模式（讀取，lock_guard/shared_lock） / Compute-bound Read using lock_guard/shared_lock ------
-    double timeMutexRead = testLockPerformance(mtx, numThreads, readIterations, false, false, true);
-    double timeSharedRead = testLockPerformance(shrdMtx, numThreads, readIterations, false, false, true);
-    std::cout << std::setw(widthLabel) << "Compute-bound Read (lock_guard/shared_lock) / 計算密集 (讀取, lock_guard/shared_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexRead << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedRead << " sec\n\n";
+    /// 開始（或重新開始）交易：取得讀取版本號並清空讀寫集合
+    void begin()
+    {
+        readVersion_ = stm_.clock_.load(std::memory_order_acquire);
+        log_.readStripes.clear();
+        log_.writes.clear();
+    }
 
-    // ------ 計算密集模式（讀取，unique_lock/shared_lock） / Compute-bound Read using unique_lock/shared_lock ------
-    double timeMutexReadUL = testLockPerformance(mtx, numThreads, readIterations, false, true, true);
-    double timeSharedReadUL = testLockPerformance(shrdMtx, numThreads, readIterations, false, true, true);
-    std::cout << std::setw(widthLabel) << "Compute-bound Read (unique_lock/shared_lock) / 計算密集 (讀取, unique_lock/shared_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexReadUL << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedReadUL << " sec\n\n";
+    /// 交易式讀取：先看自己的寫入集合，否則以「鎖前後版本一致且不新於讀取版本」驗證
+    int read(int index)
+    {
+        for (const auto& w : log_.writes)
+        {
+            if (w.first == index)
+                return w.second;                                // 讀到自己尚未提交的寫入
+        }
 
-    // ------ I/O 密集模式（讀取，lock_guard/shared_lock） / I/O-bound Read using lock_guard/shared_lock ------
-    double timeMutexIORead = testLockPerformance(mtx, numThreads, ioReadIterations, true, false, true);
-    double timeSharedIORead = testLockPerformance(shrdMtx, numThreads, ioReadIterations, true, false, true);
-    std::cout << std::setw(widthLabel) << "I/O-bound Read (lock_guard/shared_lock) / I/O密集 (讀取, lock_guard/shared_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIORead << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedIORead << " sec\n\n";
+        int stripe = stm_.stripeOf(index);
+        auto& lock = stm_.stripes_[stripe];
+        unsigned long long before = lock.load(std::memory_order_acquire);
+        int value = stm_.data_[index].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);    // 確保讀值發生在第二次讀鎖之前
+        unsigned long long after = lock.load(std::memory_order_relaxed);
 
-    // ------ I/O 密集模式（讀取，unique_lock/shared_lock） / I/O-bound Read using unique_lock/shared_lock ------
-    double timeMutexIOReadUL = testLockPerformance(mtx, numThreads, ioReadIterations, true, true, true);
-    double timeSharedIOReadUL = testLockPerformance(shrdMtx, numThreads, ioReadIterations, true, true, true);
-    std::cout << std::setw(widthLabel) << "I/O-bound Read (unique_lock/shared_lock) / I/O密集 (讀取, unique_lock/shared_lock):\n";
-    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOReadUL << " sec\n";
-    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedIOReadUL << " sec\n";
+        // 條帶被鎖定、讀取期間被修改，或版本比交易開始時新 → 中止
+        if ((before & 1) || before != after || (before >> 1) > readVersion_)
+            throw TransactionAbort{};
 
-    // ------ 細粒度鎖 vs 粗粒度鎖 測試 / Fine-grained vs Coarse-grained Lock Tests ------
-    int dataSize = 1000;         // 向量大小 / Vector size
-    int vecIterations = 100000;  // 向量更新迭代次數（計算密集）/ Iterations per thread for compute-bound vector update
-    int ioVecIterations = 1000;  // 向量更新迭代次數（I/O密集）/ Iterations per thread for I/O-bound vector update
+        log_.readStripes.push_back(stripe);
+        return value;
+    }
 
-    std::cout << "\n=== Fine-grained vs Coarse-grained Lock Tests / 細粒度鎖 vs 粗粒度鎖 性能測試 ===\n\n";
+    /// 交易式寫入：只寫入暫存的寫入集合，提交時才真正寫回
+    void write(int index, int value)
+    {
+        for (auto& w : log_.writes)
+        {
+            if (w.first == index)
+            {
+                w.second = value;
+                return;
+            }
+        }
+        log_.writes.emplace_back(index, value);
+    }
 
-    // ------ 粗粒度鎖測試（全局鎖）------
-    double coarseCompute = testCoarseGrainedVectorPerformance(numThreads, vecIterations, dataSize, false);
-    double coarseIO = testCoarseGrainedVectorPerformance(numThreads, ioVecIterations, dataSize, true);
-    std::cout << std::setw(widthLabel) << "Coarse-grained (Global Mutex) Compute-bound / 粗粒度 (全局鎖) 計算密集:\n";
-    std::cout << std::setw(widthLabel) << "  Global mutex / 全局鎖:" << std::setw(widthTime) << coarseCompute << " sec\n";
-    std::cout << std::setw(widthLabel) << "Coarse-grained (Global Mutex) I/O-bound / 粗粒度 (全局鎖) I/O密集:\n";
-    std::cout << std::setw(widthLabel) << "  Global mutex / 全局鎖:" << std::setw(widthTime) << coarseIO << " sec\n\n";
+    /// 提交：依條帶編號遞增順序鎖定寫入集合 → 遞增時鐘 → 驗證讀取集合 → 寫回並解鎖
+    bool commit()
+    {
+        if (log_.writes.empty())
+            return true;                                        // 唯讀交易：每次讀取都已驗證過
 
-    // ------ 細粒度鎖測試（每個元素一把鎖，使用 std::mutex）------
-    double fineCompute = testFineGrainedVectorPerformance(numThreads, vecIterations, dataSize, false);
-    double fineIO = testFineGrainedVectorPerformance(numThreads, ioVecIterations, dataSize, true);
-    std::cout << std::setw(widthLabel) << "Fine-grained (Per-element Mutex) Compute-bound / 細粒度 (每個元素鎖) 計算密集:\n";
-    std::cout << std::setw(widthLabel) << "  Per-element mutex / 每個元素鎖:" << std::setw(widthTime) << fineCompute << " sec\n";
-    std::cout << std::setw(widthLabel) << "Fine-grained (Per-element Mutex) I/O-bound / 細粒度 (每個元素鎖) I/O密集:\n";
-    std::cout << std::setw(widthLabel) << "  Per-element mutex / 每個元素鎖:" << std::setw(widthTime) << fineIO << " sec\n\n";
+        auto& locked = log_.lockedStripes;
+        locked.clear();
+        for (const auto& w : log_.writes)
+            locked.emplace_back(stm_.stripeOf(w.first), 0ULL);
+        std::sort(locked.begin(), locked.end());
+        locked.erase(std::unique(locked.begin(), locked.end(),
+                                 [](const auto& a, const auto& b) { return a.first == b.first; }),
+                     locked.end());
+
+        // 固定順序取得條帶鎖；無法在有限次數內取得時放棄，避免與其他提交者互相等待
+        for (std::size_t i = 0; i < locked.size(); ++i)
+        {
+            auto& lock = stm_.stripes_[locked[i].first];
+            bool acquired = false;
+            for (int spin = 0; spin < 64 && !acquired; ++spin)
+            {
+                unsigned long long current = lock.load(std::memory_order_relaxed);
+                if (!(current & 1) &&
+                    lock.compare_exchange_weak(current, current | 1, std::memory_order_acquire))
+                {
+                    locked[i].second = current;
+                    acquired = true;
+                }
+            }
+            if (!acquired)
+            {
+                releaseLocks(i);
+                return false;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);    // 讓鎖定位元先於新資料被看見
+
+        unsigned long long writeVersion = stm_.clock_.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        // 若期間有其他交易提交，需確認讀取集合仍然有效
+        if (writeVersion != readVersion_ + 1)
+        {
+            for (int stripe : log_.readStripes)
+            {
+                unsigned long long current = stm_.stripes_[stripe].load(std::memory_order_acquire);
+                auto it = std::lower_bound(locked.begin(), locked.end(), stripe,
+                                           [](const auto& l, int s) { return l.first < s; });
+                if (it != locked.end() && it->first == stripe)
+                    current = it->second;                       // 自己鎖定的條帶：以鎖定前的版本判斷
+                if ((current & 1) || (current >> 1) > readVersion_)
+                {
+                    releaseLocks(locked.size());
+                    return false;
+                }
+            }
+        }
+
+        for (const auto& w : log_.writes)
+            stm_.data_[w.first].store(w.second, std::memory_order_relaxed);
+        for (const auto& l : locked)
+            stm_.stripes_[l.first].store(writeVersion << 1, std::memory_order_release);  // 解鎖並發布新版本
+        return true;
+    }
+
+private:
+    /// 還原前 count 個已鎖定條帶的原始版本（中止時使用）
+    void releaseLocks(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            stm_.stripes_[log_.lockedStripes[i].first].store(log_.lockedStripes[i].second, std::memory_order_release);
+    }
+
+    Tl2Stm& stm_;
+    TransactionLog& log_;
+    unsigned long long readVersion_ = 0;
+};
+
+template<typename Func>
+void Tl2Stm::atomically(Func&& fn)
+{
+    thread_local TransactionLog log;                            // 每個執行緒重複使用的讀寫紀錄
+    Transaction tx(*this, log);
+    for (;;)
+    {
+        tx.begin();
+        try
+        {
+            fn(tx);
+            if (tx.commit())
+                return;
+        }
+        catch (const TransactionAbort&)
+        {
+        }
+        aborts_.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::yield();                              // 衝突後稍微退讓再重試
+    }
+}
+
+//===================================================================
+// 多元素轉帳測試：STM vs scoped_lock / Multi-element Transfer Test
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 測試轉帳性能（STM）
+/// 每次隨機選兩個不同索引，從 from 扣 1 加到 to；dataSize 越小，衝突越激烈
+/// 結束後檢查總和是否守恆；aborts 回傳交易中止（重試）的次數
+double testStmTransferPerformance(int numThreads, int iterations, int dataSize, long long& aborts)
+{
+    const int initialValue = 1000;
+    Tl2Stm stm(dataSize, dataSize, initialValue);               // 每個元素一個條帶
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pick(0, dataSize - 1);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int from = pick(rng);
+            int to = pick(rng);
+            if (from == to)
+                to = (to + 1) % dataSize;
+            stm.atomically([&](Tl2Stm::Transaction& tx)
+            {
+                tx.write(from, tx.read(from) - 1);
+                tx.write(to, tx.read(to) + 1);
+            });
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    long long total = 0;
+    for (int i = 0; i < dataSize; i++)
+        total += stm.peek(i);
+    if (total != static_cast<long long>(initialValue) * dataSize)
+        std::cerr << "[STM] Invariant violated: total = " << total << "\n";
+    aborts = stm.abortCount();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試轉帳性能（細粒度鎖 + std::scoped_lock）
+/// scoped_lock 一次鎖定兩把元素鎖，並以內建的避免死結演算法處理取得順序
+double testScopedLockTransferPerformance(int numThreads, int iterations, int dataSize)
+{
+    const int initialValue = 1000;
+    std::vector<int> data(dataSize, initialValue);
+    std::vector<std::mutex> locks(dataSize);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pick(0, dataSize - 1);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int from = pick(rng);
+            int to = pick(rng);
+            if (from == to)
+                to = (to + 1) % dataSize;
+            std::scoped_lock lock(locks[from], locks[to]);
+            data[from]--;
+            data[to]++;
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    long long total = 0;
+    for (int value : data)
+        total += value;
+    if (total != static_cast<long long>(initialValue) * dataSize)
+        std::cerr << "[scoped_lock] Invariant violated: total = " << total << "\n";
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//===================================================================
+// 範圍鎖 / Range Lock (Interval-based Shared/Exclusive Locking)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 以區間 [begin, end) 為單位的讀寫鎖
+///   獨占範圍 (lock)        ：與任何重疊的範圍互斥
+///   共享範圍 (lock_shared) ：只與重疊的獨占範圍互斥，多個掃描可同時進行
+///   不重疊的範圍彼此完全獨立，一次取得即可保護整段連續元素
+/// 共享請求會讓位給正在等待的重疊獨占請求，避免寫入者被持續的掃描餓死
+/// Interval lock over [begin, end): one acquisition protects a whole slice,
+/// disjoint slices proceed in parallel, overlapping scans share.
+class RangeLock
+{
+public:
+    void lock(int begin, int end)
+    {
+        std::unique_lock<std::mutex> guard(mutex_);
+        waitingExclusive_.push_back({ begin, end, true });
+        released_.wait(guard, [&] { return !overlapsHeld(begin, end, false); });
+        eraseRange(waitingExclusive_, begin, end, true);
+        held_.push_back({ begin, end, true });
+    }
+
+    void unlock(int begin, int end) { release(begin, end, true); }
+
+    void lock_shared(int begin, int end)
+    {
+        std::unique_lock<std::mutex> guard(mutex_);
+        released_.wait(guard, [&] { return !overlapsHeld(begin, end, true) && !overlapsWaiting(begin, end); });
+        held_.push_back({ begin, end, false });
+    }
+
+    void unlock_shared(int begin, int end) { release(begin, end, false); }
+
+private:
+    struct Range
+    {
+        int begin;
+        int end;
+        bool exclusive;
+    };
+
+    static bool overlaps(const Range& r, int begin, int end) { return r.begin < end && begin < r.end; }
+
+    /// exclusiveOnly 為 true 時只考慮已持有的獨占範圍（共享請求使用）
+    bool overlapsHeld(int begin, int end, bool exclusiveOnly) const
+    {
+        for (const auto& r : held_)
+        {
+            if ((!exclusiveOnly || r.exclusive) && overlaps(r, begin, end))
+                return true;
+        }
+        return false;
+    }
+
+    bool overlapsWaiting(int begin, int end) const
+    {
+        for (const auto& r : waitingExclusive_)
+        {
+            if (overlaps(r, begin, end))
+                return true;
+        }
+        return false;
+    }
+
+    static void eraseRange(std::vector<Range>& ranges, int begin, int end, bool exclusive)
+    {
+        for (auto& r : ranges)
+        {
+            if (r.begin == begin && r.end == end && r.exclusive == exclusive)
+            {
+                r = ranges.back();
+                ranges.pop_back();
+                return;
+            }
+        }
+    }
+
+    void release(int begin, int end, bool exclusive)
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            eraseRange(held_, begin, end, exclusive);
+        }
+        released_.notify_all();
+    }
+
+    std::mutex mutex_;                          // 只保護範圍清單本身，持有時間極短
+    std::condition_variable released_;          // 有範圍被釋放時喚醒等待者
+    std::vector<Range> held_;                   // 目前持有的範圍
+    std::vector<Range> waitingExclusive_;       // 正在等待的獨占範圍
+};
+
+/// -----------------------------------------------------------------
+/// 範圍鎖的 RAII 包裝，離開作用域時自動釋放
+class ScopedRange
+{
+public:
+    ScopedRange(RangeLock& rangeLock, int begin, int end, bool exclusive)
+        : rangeLock_(rangeLock), begin_(begin), end_(end), exclusive_(exclusive)
+    {
+        if (exclusive_)
+            rangeLock_.lock(begin_, end_);
+        else
+            rangeLock_.lock_shared(begin_, end_);
+    }
+
+    ~ScopedRange()
+    {
+        if (exclusive_)
+            rangeLock_.unlock(begin_, end_);
+        else
+            rangeLock_.unlock_shared(begin_, end_);
+    }
+
+    ScopedRange(const ScopedRange&) = delete;
+    ScopedRange& operator=(const ScopedRange&) = delete;
+
+private:
+    RangeLock& rangeLock_;
+    int begin_;
+    int end_;
+    bool exclusive_;
+};
+
+//===================================================================
+// 連續區段批次操作測試 / Bulk Range Workload Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 批次操作的區段起點：各執行緒以不同步長掃過整個向量
+int bulkRangeStart(int threadId, int i, int dataSize, int rangeLength)
+{
+    long long step = 7919LL * (threadId + 1);
+    return static_cast<int>((step * i + static_cast<long long>(threadId) * rangeLength) % (dataSize - rangeLength + 1));
+}
+
+/// -----------------------------------------------------------------
+/// 測試批次區段性能（範圍鎖）
+///   rangeLength ：每次操作的連續元素個數
+///   scanPercent ：掃描（讀取加總）操作所佔百分比，其餘為整段遞增（寫入）
+double testRangeLockBulkPerformance(int numThreads, int iterations, int dataSize, int rangeLength, int scanPercent)
+{
+    std::vector<int> data(dataSize, 0);
+    RangeLock rangeLock;                                         // 一把範圍鎖保護整個向量
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int begin = bulkRangeStart(threadId, i, dataSize, rangeLength);
+            int end = begin + rangeLength;
+            if (i % 100 < scanPercent)
+            {
+                ScopedRange range(rangeLock, begin, end, false);  // 共享範圍：掃描
+                long long sum = 0;
+                for (int j = begin; j < end; j++)
+                    sum += data[j];
+                volatile long long dummy = sum;
+                (void)dummy;
+            }
+            else
+            {
+                ScopedRange range(rangeLock, begin, end, true);   // 獨占範圍：整段更新
+                for (int j = begin; j < end; j++)
+                    data[j]++;
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試批次區段性能（逐元素上鎖）
+/// 依索引遞增順序逐一鎖定區段內每個元素的鎖，操作完再全部釋放
+double testPerElementBulkPerformance(int numThreads, int iterations, int dataSize, int rangeLength, int scanPercent)
+{
+    std::vector<int> data(dataSize, 0);
+    std::vector<std::mutex> locks(dataSize);                     // 每個元素一把鎖
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int begin = bulkRangeStart(threadId, i, dataSize, rangeLength);
+            int end = begin + rangeLength;
+            for (int j = begin; j < end; j++)
+                locks[j].lock();                                 // 固定遞增順序，避免死結
+            if (i % 100 < scanPercent)
+            {
+                long long sum = 0;
+                for (int j = begin; j < end; j++)
+                    sum += data[j];
+                volatile long long dummy = sum;
+                (void)dummy;
+            }
+            else
+            {
+                for (int j = begin; j < end; j++)
+                    data[j]++;
+            }
+            for (int j = begin; j < end; j++)
+                locks[j].unlock();
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試批次區段性能（全局鎖）
+/// 與 testCoarseGrainedVectorPerformance 相同，所有操作共用 globalMutex
+double testGlobalMutexBulkPerformance(int numThreads, int iterations, int dataSize, int rangeLength, int scanPercent)
+{
+    std::vector<int> data(dataSize, 0);
+    std::mutex globalMutex;                                      // 全局鎖
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int begin = bulkRangeStart(threadId, i, dataSize, rangeLength);
+            int end = begin + rangeLength;
+            std::lock_guard<std::mutex> lock(globalMutex);
+            if (i % 100 < scanPercent)
+            {
+                long long sum = 0;
+                for (int j = begin; j < end; j++)
+                    sum += data[j];
+                volatile long long dummy = sum;
+                (void)dummy;
+            }
+            else
+            {
+                for (int j = begin; j < end; j++)
+                    data[j]++;
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//===================================================================
+// 樂觀版本讀取 / Optimistic Versioned Reads (Per-element Seqlock)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 每個元素附帶一個版本計數器的向量
+///   寫入者：持有該元素的鎖，版本號先 +1（奇數代表寫入中），寫入資料，再 +1（回到偶數）
+///   讀取者：不上鎖、不寫入任何共享變數；讀取前後的版本號相同且為偶數才算成功，否則重試
+/// 讀取端完全不修改鎖字組，因此多個讀取者不會在同一條快取線上互相競爭
+/// Each element carries a version counter: writers bump it around the update under
+/// the element's mutex, readers validate it without ever writing shared memory.
+class VersionedVector
+{
+public:
+    explicit VersionedVector(int dataSize)
+        : values_(dataSize), versions_(dataSize), writeLocks_(dataSize) {}
+
+    int read(int index) const
+    {
+        for (;;)
+        {
+            unsigned before = versions_[index].load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();                      // 寫入中，讓出 CPU 給寫入者
+                continue;
+            }
+            int value = values_[index].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);  // 確保讀值發生在第二次讀版本之前
+            if (versions_[index].load(std::memory_order_relaxed) == before)
+                return value;
+        }
+    }
+
+    void increment(int index)
+    {
+        std::lock_guard<std::mutex> lock(writeLocks_[index]);  // 寫入者之間仍以每個元素的鎖互斥
+        unsigned version = versions_[index].load(std::memory_order_relaxed);
+        versions_[index].store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);   // 讓奇數版本先於新資料被看見
+        values_[index].store(values_[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        versions_[index].store(version + 2, std::memory_order_release);
+    }
+
+private:
+    std::vector<std::atomic<int>> values_;
+    std::vector<std::atomic<unsigned>> versions_;
+    std::vector<std::mutex> writeLocks_;
+};
+
+//===================================================================
+// 讀多寫少混合測試 / Read-heavy Mix Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 測試讀寫混合性能（細粒度 shared_mutex）
+/// 與 testFineGrainedVectorPerformanceShared 相同的每元素 shared_mutex，
+/// 但 readPercent% 的操作以 shared_lock 讀取，其餘以 lock_guard 遞增
+double testFineGrainedVectorReadMixShared(int numThreads, int iterations, int dataSize, int readPercent)
+{
+    std::vector<int> data(dataSize, 0);
+    std::vector<std::shared_mutex> locks(dataSize);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pick(0, dataSize - 1);
+        std::uniform_int_distribution<int> pickOp(0, 99);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int index = pick(rng);                              // 索引與讀寫選擇各自獨立，讀者與寫入者才會碰到同一元素
+            if (pickOp(rng) < readPercent)
+            {
+                std::shared_lock<std::shared_mutex> lock(locks[index]);  // 讀取：共享鎖定
+                volatile int dummy = data[index];
+                (void)dummy;
+            }
+            else
+            {
+                std::lock_guard<std::shared_mutex> lock(locks[index]);   // 寫入：獨占鎖定
+                data[index]++;
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試讀寫混合性能（樂觀版本讀取）
+/// 讀取以版本號驗證，不取得任何鎖；寫入在每個元素的鎖內遞增版本號
+double testOptimisticVectorReadMix(int numThreads, int iterations, int dataSize, int readPercent)
+{
+    VersionedVector data(dataSize);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pick(0, dataSize - 1);
+        std::uniform_int_distribution<int> pickOp(0, 99);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int index = pick(rng);                              // 索引與讀寫選擇各自獨立，讀者與寫入者才會碰到同一元素
+            if (pickOp(rng) < readPercent)
+            {
+                volatile int dummy = data.read(index);
+                (void)dummy;
+            }
+            else
+            {
+                data.increment(index);
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//===================================================================
+// 一致性快照 / Consistent Snapshot (Epoch-based Copy-on-Write)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 支援「時間點快照」的計數器表
+///   資料切成固定大小的區塊，每個區塊有自己的鎖
+///   快照開始時把 epoch 改成奇數（進行中）；寫入者若發現區塊尚未在本次快照中保存，
+///   先把整個區塊複製到 preserved（寫入時複製），再寫入
+///   快照逐一走訪區塊：已被保存者取 preserved，否則直接複製目前的值並標記為已保存
+/// 寫入者最多只會被一個區塊（64 個 int）的複製時間擋住
+/// Counter table with point-in-time snapshots: writers copy a chunk aside the first
+/// time they touch it during a snapshot, so they never wait longer than one chunk copy.
+class SnapshotCounterTable
+{
+public:
+    static constexpr int kChunkSize = 64;
+
+    explicit SnapshotCounterTable(int dataSize)
+        : dataSize_(dataSize), chunks_((dataSize + kChunkSize - 1) / kChunkSize) {}
+
+    void increment(int index)
+    {
+        Chunk& chunk = chunks_[index / kChunkSize];
+        std::lock_guard<std::mutex> lock(chunk.mutex);
+        unsigned long long epoch = epoch_.load(std::memory_order_acquire);
+        if ((epoch & 1) && chunk.savedEpoch != epoch)
+        {
+            chunk.preserved = chunk.values;                     // 快照進行中且尚未保存：先保存舊值
+            chunk.savedEpoch = epoch;
+        }
+        chunk.values[index % kChunkSize]++;
+    }
+
+    /// 取得時間點一致的快照（寫入時複製，寫入者幾乎不受影響）
+    void snapshot(std::vector<int>& out)
+    {
+        std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);  // 同一時間只進行一個快照
+        out.resize(dataSize_);
+        unsigned long long epoch = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;  // 奇數：快照開始
+        for (std::size_t c = 0; c < chunks_.size(); ++c)
+        {
+            Chunk& chunk = chunks_[c];
+            std::lock_guard<std::mutex> lock(chunk.mutex);
+            const auto& source = (chunk.savedEpoch == epoch) ? chunk.preserved : chunk.values;
+            chunk.savedEpoch = epoch;                           // 已複製，之後的寫入不需再保存
+            copyChunk(c, source, out);
+        }
+        epoch_.fetch_add(1, std::memory_order_acq_rel);         // 偶數：快照結束
+    }
+
+    /// 對照組：鎖住所有區塊後再複製（停止所有寫入者直到複製完成）
+    void snapshotStopTheWorld(std::vector<int>& out)
+    {
+        std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+        out.resize(dataSize_);
+        for (auto& chunk : chunks_)
+            chunk.mutex.lock();
+        for (std::size_t c = 0; c < chunks_.size(); ++c)
+            copyChunk(c, chunks_[c].values, out);
+        for (auto& chunk : chunks_)
+            chunk.mutex.unlock();
+    }
+
+private:
+    struct alignas(64) Chunk
+    {
+        std::mutex mutex;
+        unsigned long long savedEpoch = 0;                      // 最近一次被保存（或複製）時的快照 epoch
+        std::array<int, kChunkSize> values{};                   // 目前的值
+        std::array<int, kChunkSize> preserved{};                // 快照開始時的值
+    };
+
+    void copyChunk(std::size_t c, const std::array<int, kChunkSize>& source, std::vector<int>& out) const
+    {
+        int begin = static_cast<int>(c) * kChunkSize;
+        int count = std::min(kChunkSize, dataSize_ - begin);
+        std::copy(source.begin(), source.begin() + count, out.begin() + begin);
+    }
+
+    int dataSize_;
+    std::vector<Chunk> chunks_;
+    std::atomic<unsigned long long> epoch_{0};                  // 奇數代表快照進行中
+    std::mutex snapshotMutex_;
+};
+
+/// -----------------------------------------------------------------
+/// 快照測試結果
+struct SnapshotResult
+{
+    double writerSec = 0.0;          // 寫入者完成全部遞增的時間
+    int snapshots = 0;               // 期間完成的快照數
+    double avgSnapshotMs = 0.0;      // 平均快照延遲
+    double maxSnapshotMs = 0.0;      // 最大快照延遲
+};
+
+/// -----------------------------------------------------------------
+/// 測試快照對寫入者的影響
+///   snapshotMode ：0 = 不做快照，1 = 寫入時複製快照，2 = 鎖住全部區塊的快照
+/// 快照執行緒在寫入期間持續取快照，並檢查每次快照的總和不會倒退
+SnapshotResult testSnapshotPerformance(int numThreads, int iterations, int dataSize, int snapshotMode)
+{
+    SnapshotCounterTable table(dataSize);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<bool> writersDone(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    SnapshotResult result;
+
+    auto threadFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int index = static_cast<int>((static_cast<unsigned long long>(i) * 2654435761ULL + threadId) % dataSize);
+            table.increment(index);
+        }
+    };
+
+    auto snapshotFunc = [&]()
+    {
+        std::vector<int> copy;
+        long long lastTotal = 0;
+        double totalMs = 0.0;
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        while (!writersDone)
+        {
+            auto begin = std::chrono::high_resolution_clock::now();
+            if (snapshotMode == 1)
+                table.snapshot(copy);
+            else
+                table.snapshotStopTheWorld(copy);
+            auto end = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+            totalMs += ms;
+            result.maxSnapshotMs = std::max(result.maxSnapshotMs, ms);
+            result.snapshots++;
+
+            long long total = 0;
+            for (int value : copy)
+                total += value;
+            if (total < lastTotal)
+                std::cerr << "[Snapshot] Inconsistent snapshot: total went backwards\n";
+            lastTotal = total;
+        }
+        if (result.snapshots > 0)
+            result.avgSnapshotMs = totalMs / result.snapshots;
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+    std::thread snapshotThread;
+    if (snapshotMode != 0)
+        snapshotThread = std::thread(snapshotFunc);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    writersDone = true;
+    if (snapshotThread.joinable())
+        snapshotThread.join();
+
+    result.writerSec = std::chrono::duration<double>(endTime - startTime).count();
+    return result;
+}
+
+//===================================================================
+// Left-Right 併發控制 / Left-Right Concurrency Control
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 讀者指示器：記錄目前有多少讀者正在讀取
+/// 計數分散在多個獨立快取線上的槽位，每個執行緒固定使用其中一個，避免所有讀者爭搶同一個計數器
+/// Reader indicator: per-slot padded counters so concurrent readers do not share a cache line.
+class ReaderIndicator
+{
+public:
+    void arrive() { slots_[slotIndex()].count.fetch_add(1); }
+    void depart() { slots_[slotIndex()].count.fetch_sub(1, std::memory_order_release); }
+
+    bool isEmpty() const
+    {
+        for (const auto& slot : slots_)
+        {
+            if (slot.count.load() != 0)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int kSlots = 64;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<long long> count{0};
+    };
+
+    static int slotIndex()
+    {
+        static std::atomic<int> nextSlot{0};
+        thread_local int slot = nextSlot.fetch_add(1) % kSlots;   // 每個執行緒第一次使用時分配槽位
+        return slot;
+    }
+
+    std::array<Slot, kSlots> slots_;
+};
+
+/// -----------------------------------------------------------------
+/// Left-Right：同一份資料保存兩個副本
+///   讀者：登記到目前版本的讀者指示器，讀取「作用中」副本，離開時取消登記（wait-free，不會被寫入者阻塞）
+///   寫者：修改非作用中副本 → 切換作用中副本 → 等待仍在讀舊副本的讀者離開 → 在舊副本重放同一修改
+/// 寫者之間以 writerMutex_ 互斥，修改函式會被執行兩次，因此必須是可重放的
+/// Two copies of T: readers never block, the single writer updates the idle copy,
+/// flips, waits for readers to drain and replays the same update on the other copy.
+template<typename T>
+class LeftRight
+{
+public:
+    explicit LeftRight(const T& initial) : instances_{ initial, initial } {}
+
+    template<typename Func>
+    auto read(Func&& fn) const
+    {
+        int versionIndex = versionIndex_.load();
+        ReaderIndicator& indicator = indicators_[versionIndex];
+        indicator.arrive();
+        struct Departure
+        {
+            ReaderIndicator& indicator;
+            ~Departure() { indicator.depart(); }               // 即使 fn 拋出例外也會離開
+        } departure{ indicator };
+        return fn(instances_[leftRight_.load()]);
+    }
+
+    template<typename Func>
+    void modify(Func&& fn)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        int active = leftRight_.load(std::memory_order_relaxed);
+        fn(instances_[1 - active]);                             // 1. 修改非作用中副本
+        leftRight_.store(1 - active);                           // 2. 新讀者改讀已修改的副本
+        toggleVersionAndWait();                                 // 3. 等待舊副本上的讀者全部離開
+        fn(instances_[active]);                                 // 4. 在舊副本重放修改，兩副本再次一致
+    }
+
+private:
+    void toggleVersionAndWait()
+    {
+        int previous = versionIndex_.load(std::memory_order_relaxed);
+        int next = 1 - previous;
+        while (!indicators_[next].isEmpty())                    // 等待上一輪遺留在 next 上的讀者
+            std::this_thread::yield();
+        versionIndex_.store(next);
+        while (!indicators_[previous].isEmpty())                // 等待切換前進入的讀者
+            std::this_thread::yield();
+    }
+
+    T instances_[2];
+    std::atomic<int> leftRight_{0};                             // 讀者目前讀取的副本
+    std::atomic<int> versionIndex_{0};                          // 新讀者登記的讀者指示器
+    mutable ReaderIndicator indicators_[2];
+    std::mutex writerMutex_;
+};
+
+/// -----------------------------------------------------------------
+/// 測試讀寫混合性能（Left-Right）
+/// 讀取永遠不等待；寫入需修改兩個副本並等待讀者離開
+double testLeftRightVectorReadMix(int numThreads, int iterations, int dataSize, int readPercent)
+{
+    LeftRight<std::vector<int>> data(std::vector<int>(dataSize, 0));
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pick(0, dataSize - 1);
+        std::uniform_int_distribution<int> pickOp(0, 99);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            int index = pick(rng);                              // 與其他讀寫混合測試相同的存取模式
+            if (pickOp(rng) < readPercent)
+            {
+                volatile int dummy = data.read([&](const std::vector<int>& v) { return v[index]; });
+                (void)dummy;
+            }
+            else
+            {
+                data.modify([&](std::vector<int>& v) { v[index]++; });
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//===================================================================
+// RCU 讀多寫少設定物件 / RCU-style Read-mostly Configuration
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 較大的設定物件，每個請求都會讀取，偶爾才更新
+struct AppConfig
+{
+    long long version = 0;
+    std::array<int, 1024> settings{};
+};
+
+/// -----------------------------------------------------------------
+/// Read-Copy-Update：以原子指標發布唯讀版本
+///   讀者：登記到讀者指示器後載入目前版本的指標，持有期間不需任何鎖
+///   寫者：複製目前版本、修改、以原子交換發布新版本，舊版本放入待回收清單
+///   回收：累積 kRetireBatch 個舊版本後等待一次寬限期 (grace period)，再一次釋放
+/// 寬限期的等待方式與 LeftRight 相同：切換版本索引並等待兩個讀者指示器依序清空
+/// Readers load the published pointer without locking; writers copy, modify and
+/// publish, deferring reclamation until a grace period covers a batch of old versions.
+template<typename T>
+class RcuCell
+{
+public:
+    /// 讀取期間持有的指標；解構時離開讀取臨界區
+    class ReadGuard
+    {
+    public:
+        ReadGuard(ReaderIndicator& indicator, const T* value) : indicator_(&indicator), value_(value) {}
+        ReadGuard(ReadGuard&& other) noexcept : indicator_(other.indicator_), value_(other.value_) { other.indicator_ = nullptr; }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard()
+        {
+            if (indicator_)
+                indicator_->depart();
+        }
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+
+    private:
+        ReaderIndicator* indicator_;
+        const T* value_;
+    };
+
+    explicit RcuCell(const T& initial) : current_(new T(initial)) {}
+
+    ~RcuCell()
+    {
+        for (T* old : retired_)
+            delete old;
+        delete current_.load();
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ReadGuard read() const
+    {
+        ReaderIndicator& indicator = indicators_[versionIndex_.load()];
+        indicator.arrive();
+        return ReadGuard(indicator, current_.load());
+    }
+
+    template<typename Func>
+    void update(Func&& fn)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        T* fresh = new T(*current_.load(std::memory_order_relaxed));  // 複製
+        fn(*fresh);                                                   // 修改
+        retired_.push_back(current_.exchange(fresh));                 // 發布，舊版本延後回收
+        if (retired_.size() >= kRetireBatch)
+        {
+            synchronize();
+            for (T* old : retired_)
+                delete old;
+            retired_.clear();
+        }
+    }
+
+private:
+    static constexpr std::size_t kRetireBatch = 32;
+
+    /// 寬限期：等待所有可能仍持有舊指標的讀者離開
+    void synchronize()
+    {
+        int previous = versionIndex_.load(std::memory_order_relaxed);
+        int next = 1 - previous;
+        while (!indicators_[next].isEmpty())
+            std::this_thread::yield();
+        versionIndex_.store(next);
+        while (!indicators_[previous].isEmpty())
+            std::this_thread::yield();
+    }
+
+    std::atomic<T*> current_;                                   // 目前發布的版本
+    std::vector<T*> retired_;                                   // 等待寬限期後回收的舊版本
+    std::atomic<int> versionIndex_{0};
+    mutable ReaderIndicator indicators_[2];
+    std::mutex writerMutex_;
+};
+
+int main()
+{
+    int numThreads = 8;         // 執行緒數量 / Number of threads
+    int iterations = 100000;    // 計算密集模式（寫入）的迭代次數 / Iterations per thread for compute-bound write
+    int ioIterations = 1000;    // I/O 密集模式（寫入）的迭代次數 / Iterations per thread for I/O-bound write
+    int readIterations = 100000;  // 計算密集模式（讀取）的迭代次數 / Iterations per thread for compute-bound read
+    int ioReadIterations = 1000;  // I/O 密集模式（讀取）的迭代次數 / Iterations per thread for I/O-bound read
+
+    // 建立兩種鎖：std::mutex（僅支援獨占）與 std::shared_mutex（支援共享讀取）
+    // Create two mutex types: std::mutex (exclusive only) and std::shared_mutex (supports shared locking)
+    std::mutex mtx;
+    std::shared_mutex shrdMtx;
+
+    // RCU 發布的設定物件：讀取不需任何鎖 / RCU-published configuration: reads take no lock
+    RcuCell<AppConfig> configRcu{ AppConfig{} };
+
+    // 輸出格式設定 / Output formatting settings
+    const int widthLabel = 50;
+    const int widthTime  = 12;
+    std::cout << std::fixed << std::setprecision(6);
+
+    // ------ 寫入操作 測試 / Writing Operation Tests (Exclusive Lock Tests) ------
+    std::cout << "\n=== Writing Operation (Exclusive Lock) Tests / 寫入操作 (獨占鎖) 測試 ===\n\n";
+
+    // ------ 計算密集模式（寫入，lock_guard） / Compute-bound Write using lock_guard
+    double timeMutexWrite = testLockPerformance(mtx, numThreads, iterations, false, false, false);
+    double timeSharedWrite = testLockPerformance(shrdMtx, numThreads, iterations, false, false, false);
+    std::cout << std::setw(widthLabel) << "Compute-bound Write (lock_guard) / 計算密集 (寫入, lock_guard):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexWrite << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedWrite << " sec\n\n";
+
+    // ------ 計算密集模式（寫入，unique_lock） / Compute-bound Write using unique_lock ------
+    double timeMutexWriteUL = testLockPerformance(mtx, numThreads, iterations, false, true, false);
+    double timeSharedWriteUL = testLockPerformance(shrdMtx, numThreads, iterations, false, true, false);
+    std::cout << std::setw(widthLabel) << "Compute-bound Write (unique_lock) / 計算密集 (寫入, unique_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexWriteUL << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedWriteUL << " sec\n\n";
+
+    // ------ I/O 密集模式（寫入，lock_guard） / I/O-bound Write using lock_guard ------
+    double timeMutexIOWrite = testLockPerformance(mtx, numThreads, ioIterations, true, false, false);
+    double timeSharedIOWrite = testLockPerformance(shrdMtx, numThreads, ioIterations, true, false, false);
+    std::cout << std::setw(widthLabel) << "I/O-bound Write (lock_guard) / I/O密集 (寫入, lock_guard):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOWrite << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedIOWrite << " sec\n\n";
+
+    // ------ I/O 密集模式（寫入，unique_lock） / I/O-bound Write using unique_lock ------
+    double timeMutexIOWriteUL = testLockPerformance(mtx, numThreads, ioIterations, true, true, false);
+    double timeSharedIOWriteUL = testLockPerformance(shrdMtx, numThreads, ioIterations, true, true, false);
+    std::cout << std::setw(widthLabel) << "I/O-bound Write (unique_lock) / I/O密集 (寫入, unique_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOWriteUL << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (exclusive) / 共享鎖 (獨占):" << std::setw(widthTime) << timeSharedIOWriteUL << " sec\n";
+
+    // ------ 讀取操作 測試 / Reading Operation Tests (Shared Lock Tests) ------
+    std::cout << "\n=== Reading Operation (Shared Lock) Tests / 讀取操作 (共享鎖) 測試 ===\n\n";
+
+    // ------ 計算密集模式（讀取，lock_guard/shared_lock） / Compute-bound Read using lock_guard/shared_lock ------
+    double timeMutexRead = testLockPerformance(mtx, numThreads, readIterations, false, false, true);
+    double timeSharedRead = testLockPerformance(shrdMtx, numThreads, readIterations, false, false, true);
+    double timeRcuRead = testLockPerformance(configRcu, numThreads, readIterations, false, false, true);
+    std::cout << std::setw(widthLabel) << "Compute-bound Read (lock_guard/shared_lock) / 計算密集 (讀取, lock_guard/shared_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexRead << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedRead << " sec\n";
+    std::cout << std::setw(widthLabel) << "  RCU (pointer read) / RCU (讀取指標):" << std::setw(widthTime) << timeRcuRead << " sec\n\n";
+
+    // ------ 計算密集模式（讀取，unique_lock/shared_lock） / Compute-bound Read using unique_lock/shared_lock ------
+    double timeMutexReadUL = testLockPerformance(mtx, numThreads, readIterations, false, true, true);
+    double timeSharedReadUL = testLockPerformance(shrdMtx, numThreads, readIterations, false, true, true);
+    std::cout << std::setw(widthLabel) << "Compute-bound Read (unique_lock/shared_lock) / 計算密集 (讀取, unique_lock/shared_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexReadUL << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedReadUL << " sec\n\n";
+
+    // ------ I/O 密集模式（讀取，lock_guard/shared_lock） / I/O-bound Read using lock_guard/shared_lock ------
+    double timeMutexIORead = testLockPerformance(mtx, numThreads, ioReadIterations, true, false, true);
+    double timeSharedIORead = testLockPerformance(shrdMtx, numThreads, ioReadIterations, true, false, true);
+    double timeRcuIORead = testLockPerformance(configRcu, numThreads, ioReadIterations, true, false, true);
+    std::cout << std::setw(widthLabel) << "I/O-bound Read (lock_guard/shared_lock) / I/O密集 (讀取, lock_guard/shared_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIORead << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedIORead << " sec\n";
+    std::cout << std::setw(widthLabel) << "  RCU (pointer read) / RCU (讀取指標):" << std::setw(widthTime) << timeRcuIORead << " sec\n\n";
+
+    // ------ I/O 密集模式（讀取，unique_lock/shared_lock） / I/O-bound Read using unique_lock/shared_lock ------
+    double timeMutexIOReadUL = testLockPerformance(mtx, numThreads, ioReadIterations, true, true, true);
+    double timeSharedIOReadUL = testLockPerformance(shrdMtx, numThreads, ioReadIterations, true, true, true);
+    std::cout << std::setw(widthLabel) << "I/O-bound Read (unique_lock/shared_lock) / I/O密集 (讀取, unique_lock/shared_lock):\n";
+    std::cout << std::setw(widthLabel) << "  std::mutex / 一般互斥鎖:" << std::setw(widthTime) << timeMutexIOReadUL << " sec\n";
+    std::cout << std::setw(widthLabel) << "  std::shared_mutex (shared_lock) / 共享鎖 (shared_lock):" << std::setw(widthTime) << timeSharedIOReadUL << " sec\n";
+
+    // ------ 細粒度鎖 vs 粗粒度鎖 測試 / Fine-grained vs Coarse-grained Lock Tests ------
+    int dataSize = 1000;         // 向量大小 / Vector size
+    int vecIterations = 100000;  // 向量更新迭代次數（計算密集）/ Iterations per thread for compute-bound vector update
+    int ioVecIterations = 1000;  // 向量更新迭代次數（I/O密集）/ Iterations per thread for I/O-bound vector update
+
+    std::cout << "\n=== Fine-grained vs Coarse-grained Lock Tests / 細粒度鎖 vs 粗粒度鎖 性能測試 ===\n\n";
+
+    // ------ 粗粒度鎖測試（全局鎖）------
+    double coarseCompute = testCoarseGrainedVectorPerformance(numThreads, vecIterations, dataSize, false);
+    double coarseIO = testCoarseGrainedVectorPerformance(numThreads, ioVecIterations, dataSize, true);
+    std::cout << std::setw(widthLabel) << "Coarse-grained (Global Mutex) Compute-bound / 粗粒度 (全局鎖) 計算密集:\n";
+    std::cout << std::setw(widthLabel) << "  Global mutex / 全局鎖:" << std::setw(widthTime) << coarseCompute << " sec\n";
+    std::cout << std::setw(widthLabel) << "Coarse-grained (Global Mutex) I/O-bound / 粗粒度 (全局鎖) I/O密集:\n";
+    std::cout << std::setw(widthLabel) << "  Global mutex / 全局鎖:" << std::setw(widthTime) << coarseIO << " sec\n\n";
+
+    // ------ 細粒度鎖測試（每個元素一把鎖，使用 std::mutex）------
+    double fineCompute = testFineGrainedVectorPerformance(numThreads, vecIterations, dataSize, false);
+    double fineIO = testFineGrainedVectorPerformance(numThreads, ioVecIterations, dataSize, true);
+    std::cout << std::setw(widthLabel) << "Fine-grained (Per-element Mutex) Compute-bound / 細粒度 (每個元素鎖) 計算密集:\n";
+    std::cout << std::setw(widthLabel) << "  Per-element mutex / 每個元素鎖:" << std::setw(widthTime) << fineCompute << " sec\n";
+    std::cout << std::setw(widthLabel) << "Fine-grained (Per-element Mutex) I/O-bound / 細粒度 (每個元素鎖) I/O密集:\n";
+    std::cout << std::setw(widthLabel) << "  Per-element mutex / 每個元素鎖:" << std::setw(widthTime) << fineIO << " sec\n\n";
+
+    // ------ STM vs scoped_lock 多元素轉帳測試 / STM vs scoped_lock Transfer Tests ------
+    int transferIterations = 100000;  // 每個執行緒的轉帳次數 / Transfers per thread
+    struct ContentionLevel { const char* label; int dataSize; };
+    const ContentionLevel contentionLevels[] = {
+        { "High contention (8 elements) / 高競爭 (8 個元素):", 8 },
+        { "Medium contention (256 elements) / 中競爭 (256 個元素):", 256 },
+        { "Low contention (65536 elements) / 低競爭 (65536 個元素):", 65536 },
+    };
+
+    std::cout << "\n=== STM vs scoped_lock Transfer Tests / 軟體交易記憶體 vs scoped_lock 轉帳測試 ===\n\n";
+    for (const auto& level : contentionLevels)
+    {
+        long long stmAborts = 0;
+        double stmTime = testStmTransferPerformance(numThreads, transferIterations, level.dataSize, stmAborts);
+        double scopedTime = testScopedLockTransferPerformance(numThreads, transferIterations, level.dataSize);
+        // 中止率 = 中止次數 / 嘗試次數（每次轉帳最後一定成功提交一次）
+        long long commits = static_cast<long long>(numThreads) * transferIterations;
+        double abortRate = 100.0 * stmAborts / (stmAborts + commits);
+        std::cout << std::setw(widthLabel) << level.label << "\n";
+        std::cout << std::setw(widthLabel) << "  TL2 STM / 軟體交易記憶體:" << std::setw(widthTime) << stmTime << " sec, "
+                  << stmAborts << " aborts (" << std::setprecision(2) << abortRate << "% of attempts)" << std::setprecision(6) << "\n";
+        std::cout << std::setw(widthLabel) << "  scoped_lock (per-element) / scoped_lock (每個元素鎖):" << std::setw(widthTime) << scopedTime << " sec\n\n";
+    }
+
+    // ------ 範圍鎖 批次區段測試 / Range Lock Bulk Tests ------
+    int bulkDataSize = 100000;   // 向量大小 / Vector size
+    int rangeLength = 1000;      // 每次操作的連續元素數 / Contiguous elements per operation
+    int bulkIterations = 2000;   // 每個執行緒的批次操作次數 / Bulk operations per thread
+    const int scanPercents[] = { 0, 50, 90 };
+
+    std::cout << "\n=== Range Lock Bulk Tests / 範圍鎖 批次區段測試 ===\n\n";
+    for (int scanPercent : scanPercents)
+    {
+        double rangeTime = testRangeLockBulkPerformance(numThreads, bulkIterations, bulkDataSize, rangeLength, scanPercent);
+        double perElementTime = testPerElementBulkPerformance(numThreads, bulkIterations, bulkDataSize, rangeLength, scanPercent);
+        double globalTime = testGlobalMutexBulkPerformance(numThreads, bulkIterations, bulkDataSize, rangeLength, scanPercent);
+        std::string label = "Bulk ranges, scan " + std::to_string(scanPercent) + "% / 批次區段，掃描 " + std::to_string(scanPercent) + "%:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Range lock / 範圍鎖:" << std::setw(widthTime) << rangeTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Per-element mutex loop / 逐元素上鎖:" << std::setw(widthTime) << perElementTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Global mutex / 全局鎖:" << std::setw(widthTime) << globalTime << " sec\n\n";
+    }
+
+    // ------ 讀多寫少混合測試 / Read-heavy Mix Tests ------
+    int mixIterations = 1000000;  // 每個執行緒的操作次數 / Operations per thread
+    // 樂觀版本讀取即為每個元素一個 seqlock；Left-Right 讓讀者永遠不需重試或等待
+    // The optimistic versioned read is a per-element seqlock; left-right readers never retry or wait
+    const int readPercents[] = { 50, 90, 99, 100 };
+
+    std::cout << "\n=== Read-heavy Mix Tests / 讀多寫少混合測試 ===\n\n";
+    for (int readPercent : readPercents)
+    {
+        double sharedMixTime = testFineGrainedVectorReadMixShared(numThreads, mixIterations, dataSize, readPercent);
+        double optimisticTime = testOptimisticVectorReadMix(numThreads, mixIterations, dataSize, readPercent);
+        double leftRightTime = testLeftRightVectorReadMix(numThreads, mixIterations, dataSize, readPercent);
+        std::string label = "Read " + std::to_string(readPercent) + "% / 讀取 " + std::to_string(readPercent) + "%:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Per-element shared_mutex / 每個元素 shared_mutex:" << std::setw(widthTime) << sharedMixTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Optimistic versioned read / 樂觀版本讀取:" << std::setw(widthTime) << optimisticTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Left-right / 左右雙副本:" << std::setw(widthTime) << leftRightTime << " sec\n\n";
+    }
+
+    // ------ 一致性快照測試 / Consistent Snapshot Tests ------
+    int snapshotDataSize = 1 << 20;    // 計數器數量 / Number of counters
+    int snapshotIterations = 500000;   // 每個寫入執行緒的遞增次數 / Increments per writer thread
+
+    std::cout << "\n=== Consistent Snapshot Tests / 一致性快照測試 ===\n\n";
+    SnapshotResult noSnapshot = testSnapshotPerformance(numThreads, snapshotIterations, snapshotDataSize, 0);
+    SnapshotResult cowSnapshot = testSnapshotPerformance(numThreads, snapshotIterations, snapshotDataSize, 1);
+    SnapshotResult stwSnapshot = testSnapshotPerformance(numThreads, snapshotIterations, snapshotDataSize, 2);
+    std::cout << std::setw(widthLabel) << "Writers only / 僅寫入者:\n";
+    std::cout << std::setw(widthLabel) << "  Writer time / 寫入時間:" << std::setw(widthTime) << noSnapshot.writerSec << " sec\n";
+    std::cout << std::setw(widthLabel) << "Copy-on-write snapshots / 寫入時複製快照:\n";
+    std::cout << std::setw(widthLabel) << "  Writer time / 寫入時間:" << std::setw(widthTime) << cowSnapshot.writerSec << " sec\n";
+    std::cout << std::setw(widthLabel) << "  Snapshots taken / 快照次數:" << std::setw(widthTime) << cowSnapshot.snapshots << "\n";
+    std::cout << std::setw(widthLabel) << "  Avg snapshot latency / 平均快照延遲:" << std::setw(widthTime) << cowSnapshot.avgSnapshotMs << " ms\n";
+    std::cout << std::setw(widthLabel) << "  Max snapshot latency / 最大快照延遲:" << std::setw(widthTime) << cowSnapshot.maxSnapshotMs << " ms\n";
+    std::cout << std::setw(widthLabel) << "Stop-the-world snapshots / 停止寫入者的快照:\n";
+    std::cout << std::setw(widthLabel) << "  Writer time / 寫入時間:" << std::setw(widthTime) << stwSnapshot.writerSec << " sec\n";
+    std::cout << std::setw(widthLabel) << "  Snapshots taken / 快照次數:" << std::setw(widthTime) << stwSnapshot.snapshots << "\n";
+    std::cout << std::setw(widthLabel) << "  Avg snapshot latency / 平均快照延遲:" << std::setw(widthTime) << stwSnapshot.avgSnapshotMs << " ms\n";
+    std::cout << std::setw(widthLabel) << "  Max snapshot latency / 最大快照延遲:" << std::setw(widthTime) << stwSnapshot.maxSnapshotMs << " ms\n\n";
 
     return 0;   // 程式結束 / End program
 }
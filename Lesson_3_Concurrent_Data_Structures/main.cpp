@@ -0,0 +1,1688 @@
+//------------------------------------------------------------------------------
+// 標頭檔說明 / Include Libraries Explanation:
+//
+// <iostream>      : 提供輸入輸出串流功能，用於 std::cout、std::endl 等.
+//                    Provides input/output stream functionality.
+//
+// <thread>        : 提供多執行緒支持，例如 std::thread、std::this_thread 等.
+//                    Provides multi-threading support.
+//
+// <mutex>         : 提供互斥鎖功能，用於保護回收域登錄表等共享資源.
+//                    Provides mutex functionality for protecting shared resources.
+//
+// <chrono>        : 提供計時與時間間隔功能，例如 sleep_for、high_resolution_clock.
+//                    Provides timing and duration functionalities.
+//
+// <vector>        : 提供動態陣列容器，用於儲存執行緒與待回收物件.
+//                    Provides dynamic array container (std::vector).
+//
+// <atomic>        : 提供原子操作類別，是無鎖資料結構與記憶體回收的基礎.
+//                    Provides atomic operations, the building block of lock-free code.
+//
+// <iomanip>       : 提供格式化輸出功能，例如 std::setw、std::setprecision.
+//                    Provides formatting manipulators.
+//
+// <unordered_set> : 提供雜湊集合，用於記錄仍存在的回收域.
+//                    Provides hash sets for tracking live reclamation domains.
+//
+// <algorithm>     : 提供 std::max、std::sort 等演算法.
+//                    Provides algorithms such as std::max and std::sort.
+//
+// <shared_mutex>  : 提供共享互斥鎖，用於雜湊表條帶鎖的共享讀取（C++17）.
+//                    Provides shared mutexes for read-shared bucket stripes (C++17).
+//
+// <unordered_map> : 提供 std::unordered_map，作為單一鎖保護的對照組.
+//                    Provides std::unordered_map as the single-lock baseline.
+//
+// <functional>    : 提供 std::hash.
+//                    Provides std::hash.
+//
+// <random>        : 提供亂數產生器，用於產生測試用的鍵.
+//                    Provides random number engines for generating test keys.
+//
+// <utility>       : 提供 std::pair 等工具類別.
+//                    Provides utility types such as std::pair.
+//
+// <string>        : 提供 std::string 與 std::to_string，用於組合輸出標籤.
+//                    Provides std::string and std::to_string for building output labels.
+//
+// <cstdint>       : 提供固定寬度整數型別，例如 std::uint64_t.
+//                    Provides fixed-width integer types such as std::uint64_t.
+//
+// <memory>        : 提供 std::unique_ptr，用於管理雜湊表的桶陣列.
+//                    Provides std::unique_ptr for owning bucket arrays.
+//
+// <cmath>         : 提供 std::pow，用於計算 Zipf 分布.
+//                    Provides std::pow for computing the Zipf distribution.
+//
+// <stack>         : 提供 std::stack，作為單一鎖保護的堆疊對照組.
+//                    Provides std::stack as the single-lock stack baseline.
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <iomanip>
+#include <unordered_set>
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+#include <functional>
+#include <random>
+#include <utility>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <cmath>
+#include <stack>
+
+//===================================================================
+// 回收域登錄表 / Reclamation Domain Registry
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 每個執行緒在每個回收域中都有一筆紀錄 (thread record)，第一次使用時向回收域取得並快取在 thread_local 中
+/// 執行緒結束時，若回收域仍然存在，就把紀錄歸還給它，讓之後的執行緒重複使用
+/// 回收域以遞增的 id 識別，避免回收域被解構後、新回收域剛好配置在相同位址而誤用舊快取
+/// Per-thread cache of (domain, record) pairs; records are handed back to live domains at thread exit.
+class DomainRegistry
+{
+public:
+    using ReleaseFunc = void (*)(void* domain, void* record);
+
+    static unsigned long long registerDomain()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        unsigned long long id = ++nextId();
+        liveDomains().insert(id);
+        return id;
+    }
+
+    static void unregisterDomain(unsigned long long id)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        liveDomains().erase(id);
+    }
+
+    /// 取得目前執行緒在該回收域的紀錄；尚未取得時回傳 nullptr
+    static void* localRecord(unsigned long long id)
+    {
+        for (const auto& entry : cache().entries)
+        {
+            if (entry.domainId == id)
+                return entry.record;
+        }
+        return nullptr;
+    }
+
+    static void cacheLocalRecord(unsigned long long id, void* domain, void* record, ReleaseFunc release)
+    {
+        cache().entries.push_back({ id, domain, record, release });
+    }
+
+private:
+    struct Entry
+    {
+        unsigned long long domainId;
+        void* domain;
+        void* record;
+        ReleaseFunc release;
+    };
+
+    struct ThreadCache
+    {
+        std::vector<Entry> entries;
+
+        ~ThreadCache()
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            for (const auto& entry : entries)
+            {
+                if (liveDomains().count(entry.domainId))
+                    entry.release(entry.domain, entry.record);   // 回收域仍存在：歸還紀錄
+            }
+        }
+    };
+
+    static std::mutex& mutex() { static std::mutex m; return m; }
+    static unsigned long long& nextId() { static unsigned long long id = 0; return id; }
+    static std::unordered_set<unsigned long long>& liveDomains() { static std::unordered_set<unsigned long long> s; return s; }
+    static ThreadCache& cache() { thread_local ThreadCache c; return c; }
+};
+
+//===================================================================
+// 以 Epoch 為基礎的記憶體回收 / Epoch-based Memory Reclamation (EBR)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// EBR 回收域
+///   全域 epoch      ：所有活躍執行緒都已觀察到目前 epoch 時才能往前推進
+///   每執行緒宣告    ：進入臨界區 (pin) 時公布自己看到的 epoch 並標記為活躍
+///   Limbo 清單      ：retire() 的物件連同當時的全域 epoch 放入自己的 limbo 清單
+///   批次釋放        ：每 retire batchSize 個物件嘗試推進 epoch，並釋放 epoch + 2 <= 全域 epoch 的物件
+/// 讀取端只有兩次原子寫入（宣告與離開）與一次完整屏障，但只要有一個執行緒停在臨界區內，epoch 就無法推進，垃圾會無限累積
+/// Epoch-based reclamation: cheap readers, batched frees, unbounded garbage if a pinned thread stalls.
+class EpochDomain
+{
+public:
+    /// 臨界區的 RAII 包裝：存活期間讀到的指標都不會被釋放
+    class Guard
+    {
+    public:
+        Guard(EpochDomain& domain, void* record) : domain_(&domain), record_(record) {}
+        Guard(Guard&& other) noexcept : domain_(other.domain_), record_(other.record_) { other.domain_ = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+        ~Guard()
+        {
+            if (domain_)
+                domain_->exit(static_cast<ThreadRecord*>(record_));
+        }
+
+    private:
+        EpochDomain* domain_;
+        void* record_;
+    };
+
+    explicit EpochDomain(std::size_t batchSize = 64)
+        : batchSize_(batchSize), id_(DomainRegistry::registerDomain()) {}
+
+    /// 解構時所有使用此回收域的執行緒都必須已結束臨界區
+    ~EpochDomain()
+    {
+        DomainRegistry::unregisterDomain(id_);
+        ThreadRecord* record = records_.load();
+        while (record)
+        {
+            for (const auto& retired : record->limbo)
+                retired.deleter(retired.pointer);
+            ThreadRecord* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /// 進入臨界區（可巢狀）
+    Guard pin()
+    {
+        ThreadRecord* record = localRecord();
+        if (record->nesting++ == 0)
+        {
+            record->epoch.store(globalEpoch_.load());
+            record->active.store(true);
+            // seq_cst 寫入之後的非 seq_cst 讀取（例如呼叫端的 acquire 讀取）仍可能被重排到寫入之前，
+            // 需要完整屏障；與 tryAdvance 開頭的屏障配對：回收端要嘛看到此宣告，要嘛此後的讀取看得到已移除的結果
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        return Guard(*this, record);
+    }
+
+    /// 物件已從資料結構中移除，待所有可能仍持有它的讀者離開後再釋放
+    void retire(void* pointer, void (*deleter)(void*))
+    {
+        ThreadRecord* record = localRecord();
+        record->limbo.push_back({ pointer, deleter, globalEpoch_.load() });
+        record->retiredCount.fetch_add(1, std::memory_order_relaxed);
+        if (++record->retiredSinceScan >= batchSize_)
+        {
+            record->retiredSinceScan = 0;
+            tryAdvance();
+            reclaim(record);
+        }
+    }
+
+    template<typename T>
+    void retire(T* pointer)
+    {
+        retire(pointer, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /// 供自行保存待回收物件的使用者（例如雜湊表擴容後的舊表）：
+    ///   從資料結構移除物件之後呼叫 retireEpoch() 並記下回傳值，之後 quiescedSince(epoch) 回傳 true 時，
+    ///   移除當下可能持有該物件的讀者都已離開，可以釋放
+    /// 與 retire() 不同，物件不放在呼叫端執行緒的 limbo 中，因此任何執行緒都可以檢查並釋放它
+    unsigned long long retireEpoch() const { return globalEpoch_.load(); }
+
+    bool quiescedSince(unsigned long long epoch)
+    {
+        tryAdvance();
+        return epoch + 2 <= globalEpoch_.load();
+    }
+
+    /// 已 retire 但尚未釋放的物件數量（統計用）
+    long long unreclaimed() const
+    {
+        long long total = 0;
+        for (ThreadRecord* record = records_.load(); record; record = record->next)
+            total += record->retiredCount.load(std::memory_order_relaxed) - record->freedCount.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    struct Retired
+    {
+        void* pointer;
+        void (*deleter)(void*);
+        unsigned long long epoch;                               // retire 當下的全域 epoch
+    };
+
+    struct alignas(64) ThreadRecord
+    {
+        std::atomic<unsigned long long> epoch{0};               // 進入臨界區時觀察到的 epoch
+        std::atomic<bool> active{false};                        // 是否在臨界區內
+        std::atomic<bool> inUse{false};                         // 是否已被某個執行緒佔用
+        std::atomic<long long> retiredCount{0};
+        std::atomic<long long> freedCount{0};
+        ThreadRecord* next = nullptr;
+
+        // 以下僅由擁有者執行緒存取
+        int nesting = 0;
+        std::size_t retiredSinceScan = 0;
+        std::vector<Retired> limbo;                             // 依 retire 順序排列，epoch 遞增
+    };
+
+    ThreadRecord* localRecord()
+    {
+        void* cached = DomainRegistry::localRecord(id_);
+        if (cached)
+            return static_cast<ThreadRecord*>(cached);
+
+        ThreadRecord* record = acquireRecord();
+        DomainRegistry::cacheLocalRecord(id_, this, record, &EpochDomain::releaseRecord);
+        return record;
+    }
+
+    /// 先嘗試重複使用已歸還的紀錄，否則新增一筆並以 CAS 加入紀錄串列
+    ThreadRecord* acquireRecord()
+    {
+        for (ThreadRecord* record = records_.load(); record; record = record->next)
+        {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return record;
+        }
+        ThreadRecord* record = new ThreadRecord;
+        record->inUse.store(true, std::memory_order_relaxed);
+        ThreadRecord* head = records_.load();
+        do
+        {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record));
+        return record;
+    }
+
+    /// 執行緒結束時呼叫：盡量釋放自己的 limbo，剩下的留給下一個使用此紀錄的執行緒
+    static void releaseRecord(void* domain, void* record)
+    {
+        auto* self = static_cast<EpochDomain*>(domain);
+        auto* r = static_cast<ThreadRecord*>(record);
+        self->tryAdvance();
+        self->reclaim(r);
+        r->inUse.store(false, std::memory_order_release);
+    }
+
+    void exit(ThreadRecord* record)
+    {
+        if (--record->nesting == 0)
+            record->active.store(false, std::memory_order_release);
+    }
+
+    /// 所有活躍執行緒都已觀察到目前 epoch 時，將全域 epoch 加一
+    void tryAdvance()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);    // 與 pin() 的屏障配對：先前的移除先於讀取宣告
+        unsigned long long epoch = globalEpoch_.load();
+        for (ThreadRecord* record = records_.load(); record; record = record->next)
+        {
+            if (record->active.load() && record->epoch.load() != epoch)
+                return;                                         // 仍有執行緒停留在舊 epoch
+        }
+        globalEpoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    /// 釋放 limbo 中 epoch + 2 <= 全域 epoch 的物件（此時不可能再有讀者持有它們）
+    void reclaim(ThreadRecord* record)
+    {
+        unsigned long long epoch = globalEpoch_.load();
+        auto& limbo = record->limbo;
+        std::size_t freed = 0;
+        while (freed < limbo.size() && limbo[freed].epoch + 2 <= epoch)
+        {
+            limbo[freed].deleter(limbo[freed].pointer);
+            ++freed;
+        }
+        limbo.erase(limbo.begin(), limbo.begin() + freed);
+        record->freedCount.fetch_add(static_cast<long long>(freed), std::memory_order_relaxed);
+    }
+
+    std::atomic<unsigned long long> globalEpoch_{0};
+    std::atomic<ThreadRecord*> records_{nullptr};               // 只增不減的紀錄串列
+    std::size_t batchSize_;
+    unsigned long long id_;
+};
+
+//===================================================================
+// 危險指標 / Hazard Pointers
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 危險指標回收域
+///   每執行緒槽位   ：讀者把「正在使用的指標」寫入自己的危險指標槽位 (protect)，再確認來源仍指向它
+///   retire 清單    ：被移除的節點放入自己的 retire 清單
+///   掃描門檻       ：清單長度達到 max(kMinScanThreshold, 2 × 全部槽位數) 時掃描所有槽位，
+///                    釋放沒有被任何槽位指向的節點
+/// 就算有執行緒停滯，它最多也只能保住 kSlotsPerThread 個節點，未回收的數量有上限
+/// Hazard pointers: readers publish what they use, retire lists are scanned against all
+/// published slots, so a stalled thread can pin at most kSlotsPerThread nodes.
+class HazardPointerDomain
+{
+public:
+    static constexpr int kSlotsPerThread = 2;
+
+    /// 佔用目前執行緒的一個危險指標槽位；解構時清空槽位
+    class Holder
+    {
+    public:
+        explicit Holder(std::atomic<void*>& slot) : slot_(&slot) {}
+        Holder(Holder&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+        Holder(const Holder&) = delete;
+        Holder& operator=(const Holder&) = delete;
+        Holder& operator=(Holder&&) = delete;
+        ~Holder() { reset(); }
+
+        /// 讀取 source 並保護讀到的指標：公布後重新讀取，兩次相同才代表公布時節點尚未被移除
+        template<typename T>
+        T* protect(const std::atomic<T*>& source)
+        {
+            T* pointer = source.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot_->store(pointer);                          // seq_cst：公布必須先於重新讀取
+                T* current = source.load();
+                if (current == pointer)
+                    return pointer;
+                pointer = current;
+            }
+        }
+
+        void reset()
+        {
+            if (slot_)
+                slot_->store(nullptr, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<void*>* slot_;
+    };
+
+    HazardPointerDomain() : id_(DomainRegistry::registerDomain()) {}
+
+    /// 解構時所有使用此回收域的執行緒都必須已釋放槽位
+    ~HazardPointerDomain()
+    {
+        DomainRegistry::unregisterDomain(id_);
+        ThreadRecord* record = records_.load();
+        while (record)
+        {
+            for (const auto& retired : record->retired)
+                retired.deleter(retired.pointer);
+            ThreadRecord* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    HazardPointerDomain(const HazardPointerDomain&) = delete;
+    HazardPointerDomain& operator=(const HazardPointerDomain&) = delete;
+
+    /// 取得目前執行緒的第 index 個槽位（同一執行緒同時持有的 Holder 需使用不同 index）
+    Holder hazard(int index)
+    {
+        return Holder(localRecord()->slots[index]);
+    }
+
+    void retire(void* pointer, void (*deleter)(void*))
+    {
+        ThreadRecord* record = localRecord();
+        record->retired.push_back({ pointer, deleter });
+        record->retiredCount.fetch_add(1, std::memory_order_relaxed);
+        std::size_t threshold = std::max<std::size_t>(kMinScanThreshold,
+                                                      2 * kSlotsPerThread * recordCount_.load(std::memory_order_relaxed));
+        if (record->retired.size() >= threshold)
+            scan(record);
+    }
+
+    template<typename T>
+    void retire(T* pointer)
+    {
+        retire(pointer, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /// 已 retire 但尚未釋放的物件數量（統計用）
+    long long unreclaimed() const
+    {
+        long long total = 0;
+        for (ThreadRecord* record = records_.load(); record; record = record->next)
+            total += record->retiredCount.load(std::memory_order_relaxed) - record->freedCount.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    static constexpr std::size_t kMinScanThreshold = 64;
+
+    struct Retired
+    {
+        void* pointer;
+        void (*deleter)(void*);
+    };
+
+    struct alignas(64) ThreadRecord
+    {
+        std::atomic<void*> slots[kSlotsPerThread] = {};         // 危險指標槽位，其他執行緒掃描時讀取
+        std::atomic<bool> inUse{false};
+        std::atomic<long long> retiredCount{0};
+        std::atomic<long long> freedCount{0};
+        ThreadRecord* next = nullptr;
+
+        std::vector<Retired> retired;                           // 僅由擁有者執行緒存取
+        std::vector<void*> scratch;                             // 掃描時收集危險指標的暫存空間
+    };
+
+    ThreadRecord* localRecord()
+    {
+        void* cached = DomainRegistry::localRecord(id_);
+        if (cached)
+            return static_cast<ThreadRecord*>(cached);
+
+        ThreadRecord* record = acquireRecord();
+        DomainRegistry::cacheLocalRecord(id_, this, record, &HazardPointerDomain::releaseRecord);
+        return record;
+    }
+
+    ThreadRecord* acquireRecord()
+    {
+        for (ThreadRecord* record = records_.load(); record; record = record->next)
+        {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return record;
+        }
+        ThreadRecord* record = new ThreadRecord;
+        record->inUse.store(true, std::memory_order_relaxed);
+        ThreadRecord* head = records_.load();
+        do
+        {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record));
+        recordCount_.fetch_add(1, std::memory_order_relaxed);
+        return record;
+    }
+
+    static void releaseRecord(void* domain, void* record)
+    {
+        auto* self = static_cast<HazardPointerDomain*>(domain);
+        auto* r = static_cast<ThreadRecord*>(record);
+        for (auto& slot : r->slots)
+            slot.store(nullptr, std::memory_order_release);
+        self->scan(r);
+        r->inUse.store(false, std::memory_order_release);
+    }
+
+    /// 收集所有執行緒公布的危險指標，釋放不在其中的 retire 節點
+    void scan(ThreadRecord* record)
+    {
+        // 與 Holder::protect 的「公布後重新讀取」配對：先前的移除（unlink）先於讀取槽位，
+        // 因此不要求呼叫端以 seq_cst 移除節點；否則可能漏看剛公布的危險指標而提早釋放
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto& hazards = record->scratch;
+        hazards.clear();
+        for (ThreadRecord* r = records_.load(); r; r = r->next)
+        {
+            for (const auto& slot : r->slots)
+            {
+                void* pointer = slot.load();
+                if (pointer)
+                    hazards.push_back(pointer);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        auto& retired = record->retired;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < retired.size(); ++i)
+        {
+            if (std::binary_search(hazards.begin(), hazards.end(), retired[i].pointer))
+                retired[kept++] = retired[i];                   // 仍被保護，留待下次掃描
+            else
+                retired[i].deleter(retired[i].pointer);
+        }
+        record->freedCount.fetch_add(static_cast<long long>(retired.size() - kept), std::memory_order_relaxed);
+        retired.resize(kept);
+    }
+
+    std::atomic<ThreadRecord*> records_{nullptr};
+    std::atomic<std::size_t> recordCount_{0};
+    unsigned long long id_;
+};
+
+//===================================================================
+// 回收測試：讀取/替換共享指標 / Reclamation Test: Read and Swap a Shared Pointer
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 測試用節點：釋放前把 magic 改成 kDeadMagic，若讀者讀到已釋放的節點就有機會被偵測到
+struct ReclaimNode
+{
+    static constexpr unsigned kAliveMagic = 0xA11CEu;
+    static constexpr unsigned kDeadMagic = 0xDEADu;
+
+    std::atomic<unsigned> magic{kAliveMagic};
+    long long payload = 0;
+};
+
+void destroyReclaimNode(void* pointer)
+{
+    auto* node = static_cast<ReclaimNode*>(pointer);
+    node->magic.store(ReclaimNode::kDeadMagic, std::memory_order_relaxed);
+    delete node;
+}
+
+/// -----------------------------------------------------------------
+/// 回收測試結果
+struct ReclamationResult
+{
+    double sec = 0.0;                 // 寫入者完成全部替換的時間
+    long long reads = 0;              // 期間讀者完成的讀取次數
+    long long retired = 0;            // retire 的節點數
+    long long peakUnreclaimed = 0;    // 觀察到的最大未釋放節點數
+    long long corruptReads = 0;       // 讀到已釋放節點的次數（應為 0）
+};
+
+/// -----------------------------------------------------------------
+/// 測試記憶體回收（壓力測試 + 效能），DomainType 為 EpochDomain 或 HazardPointerDomain
+///   numReaders    ：持續 pin → 讀取共享指標 → 檢查 magic 的讀者數
+///   numWriters    ：以新節點替換共享指標並 retire 舊節點的寫入者數
+///   iterations    ：每個寫入者的替換次數
+///   stalledThread ：若為 true，另有一個執行緒 pin 住後睡到寫入結束（模擬停滯的執行緒）
+template<typename DomainType>
+ReclamationResult testReclamation(int numReaders, int numWriters, int iterations, bool stalledThread)
+{
+    DomainType domain;
+    std::atomic<ReclaimNode*> shared(new ReclaimNode);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<bool> writersDone(false);
+    std::atomic<long long> totalReads(0);
+    std::atomic<long long> corruptReads(0);
+    std::atomic<long long> peakUnreclaimed(0);
+    std::vector<std::thread> readers;
+    std::vector<std::thread> writers;
+    int participants = numReaders + numWriters + (stalledThread ? 1 : 0);
+
+    auto readerFunc = [&]()
+    {
+        long long reads = 0;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        while (!writersDone)
+        {
+            // 編譯期依回收域型別選擇保護方式：EBR 進入臨界區；危險指標公布正在使用的節點
+            if constexpr (std::is_same<DomainType, EpochDomain>::value)
+            {
+                auto guard = domain.pin();
+                ReclaimNode* node = shared.load(std::memory_order_acquire);
+                if (node->magic.load(std::memory_order_relaxed) != ReclaimNode::kAliveMagic)
+                    corruptReads.fetch_add(1);
+                volatile long long dummy = node->payload;
+                (void)dummy;
+            }
+            else
+            {
+                auto hazard = domain.hazard(0);
+                ReclaimNode* node = hazard.protect(shared);
+                if (node->magic.load(std::memory_order_relaxed) != ReclaimNode::kAliveMagic)
+                    corruptReads.fetch_add(1);
+                volatile long long dummy = node->payload;
+                (void)dummy;
+            }
+            ++reads;
+        }
+        totalReads.fetch_add(reads);
+    };
+
+    auto writerFunc = [&](int writerId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            auto* fresh = new ReclaimNode;
+            fresh->payload = static_cast<long long>(writerId) * iterations + i;
+            ReclaimNode* old = shared.exchange(fresh, std::memory_order_acq_rel);
+            domain.retire(old, &destroyReclaimNode);
+        }
+    };
+
+    auto stalledFunc = [&]()
+    {
+        if constexpr (std::is_same<DomainType, EpochDomain>::value)
+        {
+            auto guard = domain.pin();                          // 進入臨界區後停住，epoch 無法推進
+            readyCount.fetch_add(1);
+            while (!writersDone)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        else
+        {
+            auto hazard = domain.hazard(0);
+            hazard.protect(shared);                             // 停住時只保住一個節點
+            readyCount.fetch_add(1);
+            while (!writersDone)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    for (int i = 0; i < numReaders; i++)
+        readers.emplace_back(readerFunc);
+    for (int i = 0; i < numWriters; i++)
+        writers.emplace_back(writerFunc, i);
+    std::thread stalled;
+    if (stalledThread)
+        stalled = std::thread(stalledFunc);
+
+    while (readyCount.load() < participants)
+        { std::this_thread::yield(); }
+
+    // 監控執行緒：定期取樣未釋放的節點數
+    std::thread monitor([&]()
+    {
+        while (!writersDone)
+        {
+            long long current = domain.unreclaimed();
+            if (current > peakUnreclaimed.load())
+                peakUnreclaimed.store(current);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : writers)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    writersDone = true;
+    for (auto &th : readers)
+         th.join();
+    if (stalled.joinable())
+        stalled.join();
+    monitor.join();
+
+    ReclamationResult result;
+    result.sec = std::chrono::duration<double>(endTime - startTime).count();
+    result.reads = totalReads.load();
+    result.retired = static_cast<long long>(numWriters) * iterations;
+    result.peakUnreclaimed = std::max(peakUnreclaimed.load(), domain.unreclaimed());
+    result.corruptReads = corruptReads.load();
+    delete shared.load();
+    return result;
+}
+
+//===================================================================
+// 條帶鎖雜湊表 / Concurrent Hash Map with Lock-striped Buckets
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 以條帶鎖保護桶的並行雜湊表（延伸 Lesson 2 每個元素一把鎖的想法）
+///   條帶 (stripe)  ：固定數量的 shared_mutex，桶 i 由條帶 i % stripeCount 保護
+///   桶數量         ：永遠是條帶數的倍數，因此同一個鍵在擴容前後都落在同一條帶
+///   查詢           ：只取該條帶的共享鎖；insert / erase / upsert 取該條帶的獨占鎖
+///   擴容           ：平均每桶超過 kMaxLoadFactor 個元素時，依序鎖住所有條帶後將桶數加倍
+/// 不同條帶上的操作可以同時進行；擴容期間其他操作會短暫等待
+/// Striped hash map: a fixed set of shared_mutexes guards the buckets; resize takes every stripe.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class StripedHashMap
+{
+public:
+    explicit StripedHashMap(std::size_t stripeCount = 64, std::size_t initialBuckets = 64)
+        : locks_(stripeCount),
+          buckets_(((initialBuckets + stripeCount - 1) / stripeCount) * stripeCount) {}
+
+    bool find(const Key& key, Value& out) const
+    {
+        std::size_t h = hasher_(key);
+        std::shared_lock<std::shared_mutex> lock(locks_[h % locks_.size()]);
+        const Bucket& bucket = buckets_[h % buckets_.size()];
+        for (const auto& entry : bucket)
+        {
+            if (entry.first == key)
+            {
+                out = entry.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 鍵不存在時插入；已存在則回傳 false
+    bool insert(const Key& key, const Value& value)
+    {
+        std::size_t h = hasher_(key);
+        std::size_t bucketCount;
+        {
+            std::lock_guard<std::shared_mutex> lock(locks_[h % locks_.size()]);
+            bucketCount = buckets_.size();
+            Bucket& bucket = buckets_[h % bucketCount];
+            for (const auto& entry : bucket)
+            {
+                if (entry.first == key)
+                    return false;
+            }
+            bucket.emplace_back(key, value);
+        }
+        growIfNeeded(size_.fetch_add(1) + 1, bucketCount);
+        return true;
+    }
+
+    bool erase(const Key& key)
+    {
+        std::size_t h = hasher_(key);
+        std::lock_guard<std::shared_mutex> lock(locks_[h % locks_.size()]);
+        Bucket& bucket = buckets_[h % buckets_.size()];
+        for (auto& entry : bucket)
+        {
+            if (entry.first == key)
+            {
+                entry = std::move(bucket.back());
+                bucket.pop_back();
+                size_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 鍵已存在時以 update(value) 就地修改，否則插入 initial
+    template<typename Func>
+    void upsert(const Key& key, const Value& initial, Func&& update)
+    {
+        std::size_t h = hasher_(key);
+        std::size_t bucketCount;
+        {
+            std::lock_guard<std::shared_mutex> lock(locks_[h % locks_.size()]);
+            bucketCount = buckets_.size();
+            Bucket& bucket = buckets_[h % bucketCount];
+            for (auto& entry : bucket)
+            {
+                if (entry.first == key)
+                {
+                    update(entry.second);
+                    return;
+                }
+            }
+            bucket.emplace_back(key, initial);
+        }
+        growIfNeeded(size_.fetch_add(1) + 1, bucketCount);
+    }
+
+    std::size_t size() const { return size_.load(); }
+
+private:
+    using Bucket = std::vector<std::pair<Key, Value>>;
+    static constexpr std::size_t kMaxLoadFactor = 2;
+
+    void growIfNeeded(std::size_t currentSize, std::size_t observedBuckets)
+    {
+        if (currentSize > observedBuckets * kMaxLoadFactor)
+            resize(observedBuckets);
+    }
+
+    /// 依條帶編號順序鎖住所有條帶後重新分配桶；若已被其他執行緒擴容則直接返回
+    void resize(std::size_t observedBuckets)
+    {
+        std::vector<std::unique_lock<std::shared_mutex>> allLocks;
+        allLocks.reserve(locks_.size());
+        for (auto& lock : locks_)
+            allLocks.emplace_back(lock);
+
+        if (buckets_.size() != observedBuckets)
+            return;
+
+        std::vector<Bucket> bigger(buckets_.size() * 2);        // 仍是條帶數的倍數
+        for (auto& bucket : buckets_)
+        {
+            for (auto& entry : bucket)
+                bigger[hasher_(entry.first) % bigger.size()].push_back(std::move(entry));
+        }
+        buckets_.swap(bigger);
+    }
+
+    mutable std::vector<std::shared_mutex> locks_;
+    std::vector<Bucket> buckets_;
+    std::atomic<std::size_t> size_{0};
+    Hash hasher_;
+};
+
+/// -----------------------------------------------------------------
+/// 對照組：以單一鎖保護整個 std::unordered_map（粗粒度鎖）
+/// MutexType 為 std::shared_mutex 時，find 以 shared_lock 共享讀取
+template<typename Key, typename Value, typename MutexType>
+class GlobalLockHashMap
+{
+public:
+    bool find(const Key& key, Value& out) const
+    {
+        if constexpr (std::is_same<MutexType, std::shared_mutex>::value)
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            return findLocked(key, out);
+        }
+        else
+        {
+            std::lock_guard<MutexType> lock(mutex_);
+            return findLocked(key, out);
+        }
+    }
+
+    bool insert(const Key& key, const Value& value)
+    {
+        std::lock_guard<MutexType> lock(mutex_);
+        return map_.emplace(key, value).second;
+    }
+
+    bool erase(const Key& key)
+    {
+        std::lock_guard<MutexType> lock(mutex_);
+        return map_.erase(key) > 0;
+    }
+
+    template<typename Func>
+    void upsert(const Key& key, const Value& initial, Func&& update)
+    {
+        std::lock_guard<MutexType> lock(mutex_);
+        auto result = map_.emplace(key, initial);
+        if (!result.second)
+            update(result.first->second);
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<MutexType> lock(mutex_);
+        return map_.size();
+    }
+
+private:
+    bool findLocked(const Key& key, Value& out) const
+    {
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        out = it->second;
+        return true;
+    }
+
+    mutable MutexType mutex_;
+    std::unordered_map<Key, Value> map_;
+};
+
+//===================================================================
+// 無鎖讀取開放定址雜湊表 / Lock-free-read Open-addressing Hash Map
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 讀多寫少的 uint64 → uint64 開放定址雜湊表
+///   群組 (group)    ：一條 64 位元組快取線 = 8 位元組標籤字組 + 7 個鍵；值存放在另一個平行陣列
+///   標籤比對        ：每個槽位 1 位元組標籤（雜湊值最高 7 位元 | 0x80），以 SWAR（暫存器內 SIMD）
+///                     一次比對 7 個標籤，只有標籤相符的槽位才需要比對鍵
+///   線性探測        ：以群組為單位往後探測，遇到有空槽的群組即可停止
+///   讀取            ：完全無鎖，只需在 EBR 臨界區內載入標籤、鍵與值
+///   寫入            ：寫入者之間以 writerMutex_ 互斥；先寫入鍵與值，最後以 release 發布標籤
+///   刪除            ：值改成 kTombstone，槽位保留給同一個鍵重複使用
+///   漸進式擴容      ：建立新表後舊表凍結，之後每次寫入搬移 kMigrateGroupsPerWrite 個群組；
+///                     讀者先查新表，新表沒有該鍵時再查舊表，resizeSeq_ 在查詢期間改變就重查；
+///                     搬移完成後舊表放入 retiredTables_，由之後任一寫入者在 EBR 確認讀者都已離開時釋放
+/// 值不可等於 kTombstone (~0)
+/// Lock-free reads over cache-line groups with SWAR tag matching; writers serialize,
+/// resize migrates incrementally and the frozen old table is reclaimed through EBR.
+class LockFreeReadHashMap
+{
+public:
+    static constexpr std::uint64_t kTombstone = ~0ULL;
+
+    explicit LockFreeReadHashMap(std::size_t initialGroups = 16)
+        : current_(new Table(roundUpPowerOfTwo(initialGroups))) {}
+
+    ~LockFreeReadHashMap()
+    {
+        for (const auto& retired : retiredTables_)
+            delete retired.first;
+        delete old_.load();
+        delete current_.load();
+    }
+
+    LockFreeReadHashMap(const LockFreeReadHashMap&) = delete;
+    LockFreeReadHashMap& operator=(const LockFreeReadHashMap&) = delete;
+
+    /// 先查新表、再查舊表；若查詢期間擴容開始或搬移完成（resizeSeq_ 改變），鍵可能在兩次查詢之間
+    /// 從舊表搬到新表而兩邊都沒查到，因此重新查詢直到 resizeSeq_ 在整個查詢期間維持不變
+    bool find(std::uint64_t key, std::uint64_t& out) const
+    {
+        std::uint64_t h = mix(key);
+        auto guard = epochs_.pin();
+        for (;;)
+        {
+            std::uint64_t seq = resizeSeq_.load(std::memory_order_acquire);
+            Lookup result = lookup(*current_.load(std::memory_order_acquire), key, h, out);
+            if (result != Lookup::Absent)
+                return result == Lookup::Found;
+            Table* old = old_.load(std::memory_order_acquire); // 搬移中：新表沒有的鍵再查舊表
+            if (old && lookup(*old, key, h, out) == Lookup::Found)
+                return true;
+            if (resizeSeq_.load(std::memory_order_acquire) == seq)
+                return false;
+        }
+    }
+
+    bool insert(std::uint64_t key, std::uint64_t value)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        std::uint64_t h = prepareWrite(key);
+        Table& table = *current_.load(std::memory_order_relaxed);
+        std::size_t slot = findSlot(table, key, h);
+        if (slot != kNoSlot)
+        {
+            if (table.values[slot].load(std::memory_order_relaxed) != kTombstone)
+                return false;
+            table.values[slot].store(value, std::memory_order_release);  // 重複使用被刪除的槽位
+        }
+        else
+        {
+            claimSlot(table, key, h, value);
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        finishWrite();
+        return true;
+    }
+
+    bool erase(std::uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        std::uint64_t h = prepareWrite(key);
+        Table& table = *current_.load(std::memory_order_relaxed);
+        std::size_t slot = findSlot(table, key, h);
+        bool erased = false;
+        if (slot != kNoSlot && table.values[slot].load(std::memory_order_relaxed) != kTombstone)
+        {
+            table.values[slot].store(kTombstone, std::memory_order_release);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            erased = true;
+        }
+        finishWrite();
+        return erased;
+    }
+
+    template<typename Func>
+    void upsert(std::uint64_t key, std::uint64_t initial, Func&& update)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        std::uint64_t h = prepareWrite(key);
+        Table& table = *current_.load(std::memory_order_relaxed);
+        std::size_t slot = findSlot(table, key, h);
+        if (slot != kNoSlot && table.values[slot].load(std::memory_order_relaxed) != kTombstone)
+        {
+            std::uint64_t value = table.values[slot].load(std::memory_order_relaxed);
+            update(value);
+            table.values[slot].store(value, std::memory_order_release);
+        }
+        else
+        {
+            if (slot != kNoSlot)
+                table.values[slot].store(initial, std::memory_order_release);
+            else
+                claimSlot(table, key, h, initial);
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        finishWrite();
+    }
+
+    std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kSlotsPerGroup = 7;
+    static constexpr std::size_t kNoSlot = ~static_cast<std::size_t>(0);
+    static constexpr std::size_t kMigrateGroupsPerWrite = 8;
+    static constexpr std::uint64_t kLowBytes = 0x0001010101010101ULL;   // 只涵蓋 7 個槽位的位元組
+    static constexpr std::uint64_t kHighBits = 0x0080808080808080ULL;
+
+    struct alignas(64) Group
+    {
+        std::atomic<std::uint64_t> tags{0};                     // 位元組 i 為槽位 i 的標籤，0 代表空槽
+        std::atomic<std::uint64_t> keys[kSlotsPerGroup] = {};
+    };
+
+    struct Table
+    {
+        explicit Table(std::size_t groupCount)
+            : mask(groupCount - 1),
+              groups(new Group[groupCount]),
+              values(new std::atomic<std::uint64_t>[groupCount * kSlotsPerGroup]) {}
+
+        std::size_t groupCount() const { return mask + 1; }
+        std::size_t capacity() const { return groupCount() * kSlotsPerGroup; }
+
+        std::size_t mask;
+        std::unique_ptr<Group[]> groups;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> values;
+        std::size_t used = 0;                                   // 已佔用的槽位（含已刪除），僅寫入者存取
+    };
+
+    enum class Lookup { Absent, Deleted, Found };
+
+    static std::size_t roundUpPowerOfTwo(std::size_t n)
+    {
+        std::size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    /// splitmix64 的最終混合，讓連續的鍵也能均勻分散
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    static std::uint64_t tagOf(std::uint64_t h) { return 0x80 | (h >> 57); }
+
+    /// SWAR：回傳標籤字組中等於 tag 的位元組（每個符合的位元組最高位元為 1）
+    /// 借位可能造成少數誤判，但之後一定會比對鍵，所以只影響效能不影響正確性
+    static std::uint64_t matchTag(std::uint64_t tags, std::uint64_t tag)
+    {
+        std::uint64_t x = tags ^ (tag * kLowBytes);
+        return (x - kLowBytes) & ~x & kHighBits;
+    }
+
+    static std::uint64_t matchEmpty(std::uint64_t tags)
+    {
+        return (tags - kLowBytes) & ~tags & kHighBits;
+    }
+
+    static int lowestByte(std::uint64_t bits)
+    {
+        int index = 0;
+        while (!(bits & 0x80))
+        {
+            bits >>= 8;
+            ++index;
+        }
+        return index;
+    }
+
+    /// 無鎖查詢：標籤以 acquire 載入，確保看到標籤時鍵與值都已寫入
+    static Lookup lookup(const Table& table, std::uint64_t key, std::uint64_t h, std::uint64_t& out)
+    {
+        std::uint64_t tag = tagOf(h);
+        std::size_t g = h & table.mask;
+        for (std::size_t probe = 0; probe <= table.mask; ++probe, g = (g + 1) & table.mask)
+        {
+            const Group& group = table.groups[g];
+            std::uint64_t tags = group.tags.load(std::memory_order_acquire);
+            for (std::uint64_t m = matchTag(tags, tag); m; m &= m - 1)
+            {
+                int slot = lowestByte(m & (~m + 1));
+                if (group.keys[slot].load(std::memory_order_relaxed) == key)
+                {
+                    std::uint64_t value = table.values[g * kSlotsPerGroup + slot].load(std::memory_order_acquire);
+                    if (value == kTombstone)
+                        return Lookup::Deleted;
+                    out = value;
+                    return Lookup::Found;
+                }
+            }
+            if (matchEmpty(tags))
+                return Lookup::Absent;                          // 有空槽的群組之後不可能再有這個鍵
+        }
+        return Lookup::Absent;
+    }
+
+    /// 寫入者專用：找出鍵所在的槽位（含已刪除者）
+    static std::size_t findSlot(const Table& table, std::uint64_t key, std::uint64_t h)
+    {
+        std::uint64_t tag = tagOf(h);
+        std::size_t g = h & table.mask;
+        for (std::size_t probe = 0; probe <= table.mask; ++probe, g = (g + 1) & table.mask)
+        {
+            const Group& group = table.groups[g];
+            std::uint64_t tags = group.tags.load(std::memory_order_relaxed);
+            for (std::uint64_t m = matchTag(tags, tag); m; m &= m - 1)
+            {
+                int slot = lowestByte(m & (~m + 1));
+                if (group.keys[slot].load(std::memory_order_relaxed) == key)
+                    return g * kSlotsPerGroup + slot;
+            }
+            if (matchEmpty(tags))
+                return kNoSlot;
+        }
+        return kNoSlot;
+    }
+
+    /// 寫入者專用：在第一個有空槽的群組放入新鍵，最後才發布標籤
+    static void claimSlot(Table& table, std::uint64_t key, std::uint64_t h, std::uint64_t value)
+    {
+        std::size_t g = h & table.mask;
+        for (;;)
+        {
+            Group& group = table.groups[g];
+            std::uint64_t tags = group.tags.load(std::memory_order_relaxed);
+            std::uint64_t empty = matchEmpty(tags);
+            if (empty)
+            {
+                int slot = lowestByte(empty & (~empty + 1));
+                group.keys[slot].store(key, std::memory_order_relaxed);
+                table.values[g * kSlotsPerGroup + slot].store(value, std::memory_order_relaxed);
+                group.tags.store(tags | (tagOf(h) << (8 * slot)), std::memory_order_release);
+                ++table.used;
+                return;
+            }
+            g = (g + 1) & table.mask;
+        }
+    }
+
+    /// 寫入前的準備：推進擴容搬移，並確保此鍵在舊表中的值已搬到新表
+    std::uint64_t prepareWrite(std::uint64_t key)
+    {
+        std::uint64_t h = mix(key);
+        Table* old = old_.load(std::memory_order_relaxed);
+        if (old)
+        {
+            Table& table = *current_.load(std::memory_order_relaxed);
+            std::uint64_t value;
+            if (findSlot(table, key, h) == kNoSlot && lookup(*old, key, h, value) == Lookup::Found)
+                claimSlot(table, key, h, value);
+            migrateStep(kMigrateGroupsPerWrite);
+        }
+        return h;
+    }
+
+    /// 寫入後：必要時開始擴容，並釋放讀者都已離開的舊表
+    /// 舊表存放在 retiredTables_（受 writerMutex_ 保護）而不是某個執行緒的 limbo，
+    /// 因此不論是哪個寫入者完成搬移，之後任何一個寫入者都能釋放它
+    void finishWrite()
+    {
+        Table& table = *current_.load(std::memory_order_relaxed);
+        if (table.used * 4 > table.capacity() * 3)
+            startResize();
+        while (!retiredTables_.empty() && epochs_.quiescedSince(retiredTables_.front().second))
+        {
+            delete retiredTables_.front().first;
+            retiredTables_.erase(retiredTables_.begin());
+        }
+    }
+
+    void startResize()
+    {
+        while (old_.load(std::memory_order_relaxed))
+            migrateStep(kMigrateGroupsPerWrite);                // 上一次擴容尚未完成時先搬完
+
+        Table* table = current_.load(std::memory_order_relaxed);
+        std::size_t live = size_.load(std::memory_order_relaxed);
+        std::size_t groups = std::max<std::size_t>(16, roundUpPowerOfTwo((live * 2) / kSlotsPerGroup + 1));
+        if (groups < table->groupCount())
+            groups = table->groupCount();                       // 不縮小；刪除過多時以相同大小重建
+        old_.store(table);                                      // 先公布舊表，再切換新表
+        current_.store(new Table(groups));
+        resizeSeq_.fetch_add(1);
+        migrateCursor_ = 0;
+    }
+
+    /// 搬移舊表中 count 個群組的有效鍵值（新表已存在的鍵代表較新的值，略過）
+    void migrateStep(std::size_t count)
+    {
+        Table* old = old_.load(std::memory_order_relaxed);
+        Table& table = *current_.load(std::memory_order_relaxed);
+        for (std::size_t n = 0; n < count && migrateCursor_ < old->groupCount(); ++n, ++migrateCursor_)
+        {
+            const Group& group = old->groups[migrateCursor_];
+            std::uint64_t tags = group.tags.load(std::memory_order_relaxed);
+            for (int slot = 0; slot < kSlotsPerGroup; ++slot)
+            {
+                if (!((tags >> (8 * slot)) & 0x80))
+                    continue;
+                std::uint64_t key = group.keys[slot].load(std::memory_order_relaxed);
+                std::uint64_t value = old->values[migrateCursor_ * kSlotsPerGroup + slot].load(std::memory_order_relaxed);
+                std::uint64_t h = mix(key);
+                if (value != kTombstone && findSlot(table, key, h) == kNoSlot)
+                    claimSlot(table, key, h, value);
+            }
+        }
+        if (migrateCursor_ == old->groupCount())
+        {
+            resizeSeq_.fetch_add(1);                            // 先遞增：讀到 old_ 為空的讀者必定也看到新的序號
+            old_.store(nullptr);
+            retiredTables_.emplace_back(old, epochs_.retireEpoch());   // 可能仍有讀者在查舊表
+        }
+    }
+
+    std::atomic<Table*> current_;
+    std::atomic<Table*> old_{nullptr};                          // 擴容搬移中的舊表（已凍結）
+    std::atomic<std::size_t> size_{0};
+    std::atomic<std::uint64_t> resizeSeq_{0};                  // 擴容開始與搬移完成時各遞增一次
+    std::size_t migrateCursor_ = 0;                             // 以下僅在 writerMutex_ 內存取
+    std::vector<std::pair<Table*, unsigned long long>> retiredTables_;  // 搬移完成的舊表與其 retire epoch
+    std::mutex writerMutex_;
+    mutable EpochDomain epochs_;
+};
+
+//===================================================================
+// 雜湊表測試 / Hash Map Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// Zipf 分布：第 k 個鍵被選中的機率與 1 / (k + 1)^skew 成正比（skew = 0 即均勻分布）
+/// 預先計算累積分布，每次取樣以二分搜尋完成
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(std::size_t keyRange, double skew) : cdf_(keyRange)
+    {
+        double total = 0.0;
+        for (std::size_t k = 0; k < keyRange; ++k)
+        {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf_[k] = total;
+        }
+        for (auto& c : cdf_)
+            c /= total;
+    }
+
+    template<typename Rng>
+    std::uint64_t operator()(Rng& rng) const
+    {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        if (it == cdf_.end())
+            --it;
+        return static_cast<std::uint64_t>(it - cdf_.begin());
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+/// -----------------------------------------------------------------
+/// 測試雜湊表性能
+///   map         ：待測試的雜湊表（呼叫前可先預先填入部分鍵）
+///   keyRange    ：鍵的範圍 [0, keyRange)
+///   readPercent ：find 所佔百分比，其餘平均分配給 insert / erase / upsert
+///   zipfSkew    ：鍵的 Zipf 偏斜程度，0 為均勻分布，越大則少數熱門鍵越集中
+template<typename MapType>
+double testHashMapPerformance(MapType& map, int numThreads, int iterations, int keyRange, int readPercent, double zipfSkew)
+{
+    ZipfDistribution pickKey(keyRange, zipfSkew);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> pickOp(0, 99);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            std::uint64_t key = pickKey(rng);
+            int op = pickOp(rng);
+            if (op < readPercent)
+            {
+                std::uint64_t value;
+                volatile bool found = map.find(key, value);
+                (void)found;
+            }
+            else
+            {
+                switch ((op - readPercent) % 3)
+                {
+                case 0:
+                    map.insert(key, key);
+                    break;
+                case 1:
+                    map.erase(key);
+                    break;
+                default:
+                    map.upsert(key, key, [](std::uint64_t& value) { ++value; });
+                    break;
+                }
+            }
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 預先填入 [0, count) 的鍵
+template<typename MapType>
+void prefillHashMap(MapType& map, int count)
+{
+    for (int i = 0; i < count; i++)
+        map.insert(static_cast<std::uint64_t>(i), static_cast<std::uint64_t>(i));
+}
+
+//===================================================================
+// Treiber 無鎖堆疊 / Treiber Lock-free Stack
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// Treiber 無鎖堆疊，以危險指標避免 ABA 問題
+///   push   ：新節點指向目前的 head，以 CAS 將 head 換成新節點
+///   pop    ：以危險指標保護 head 後讀取 head->next，再以 CAS 將 head 換成 next
+///   pop_all：以一次 exchange 取走整條鏈，依 LIFO 順序交給 fn 處理
+/// ABA：若 pop 讀到 head == A 後，A 被彈出、釋放，記憶體又被配置成新的 A 並推入，
+///   單純比較指標的 CAS 會誤以為 head 沒變。A 受危險指標保護期間不會被釋放，
+///   同一個位址就不可能再次出現，因此不需要 128 位元的 (tag, pointer) CAS
+/// 彈出的節點一律交給 HazardPointerDomain retire，因為其他 pop 可能仍在讀取它的 next
+/// Treiber stack with hazard-pointer protected pops (ABA-safe without double-width CAS).
+template<typename T>
+class TreiberStack
+{
+public:
+    TreiberStack() = default;
+
+    ~TreiberStack()
+    {
+        Node* node = head_.load(std::memory_order_relaxed);
+        while (node)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    TreiberStack(const TreiberStack&) = delete;
+    TreiberStack& operator=(const TreiberStack&) = delete;
+
+    void push(T value)
+    {
+        Node* node = new Node{ std::move(value), head_.load(std::memory_order_relaxed) };
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    /// 彈出頂端元素；堆疊為空時回傳 false
+    bool pop(T& out)
+    {
+        auto hazard = hazards_.hazard(0);
+        for (;;)
+        {
+            Node* top = hazard.protect(head_);
+            if (top == nullptr)
+                return false;
+            Node* next = top->next;                             // top 受保護，不會被釋放
+            // acquire 即可：retire 觸發的 scan 會先執行 seq_cst 屏障，
+            // 與其他 pop 在 protect(head_) 中的公布配對，不會漏看仍在讀 top->next 的執行緒
+            if (head_.compare_exchange_weak(top, next, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                hazard.reset();
+                out = std::move(top->value);
+                hazards_.retire(top);
+                return true;
+            }
+        }
+    }
+
+    /// 一次取走所有元素，依由上到下的順序呼叫 fn(value)，回傳元素數量
+    template<typename Func>
+    std::size_t pop_all(Func&& fn)
+    {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        std::size_t count = 0;
+        while (node)
+        {
+            Node* next = node->next;
+            fn(std::move(node->value));
+            hazards_.retire(node);
+            node = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Node
+    {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_{nullptr};
+    HazardPointerDomain hazards_;
+};
+
+/// -----------------------------------------------------------------
+/// 對照組：std::stack 以單一 std::mutex 保護
+/// Baseline: std::stack guarded by a single mutex.
+template<typename T>
+class MutexStack
+{
+public:
+    void push(T value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stack_.push(std::move(value));
+    }
+
+    bool pop(T& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stack_.empty())
+            return false;
+        out = std::move(stack_.top());
+        stack_.pop();
+        return true;
+    }
+
+    template<typename Func>
+    std::size_t pop_all(Func&& fn)
+    {
+        std::stack<T> taken;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            taken.swap(stack_);
+        }
+        std::size_t count = taken.size();
+        for (; !taken.empty(); taken.pop())
+            fn(std::move(taken.top()));
+        return count;
+    }
+
+private:
+    std::mutex mutex_;
+    std::stack<T> stack_;
+};
+
+/// -----------------------------------------------------------------
+/// 測試堆疊性能（模擬空閒串列的使用方式）
+///   每個執行緒先推入 kWarmup 個元素，之後每輪 push 一個再 pop 一個
+///   結束後以 pop_all 取走剩餘元素，檢查推入與取出的總和一致
+/// Each thread alternates push and pop; the sum check catches lost or duplicated elements.
+template<typename StackType>
+double testStackPerformance(int numThreads, int iterations)
+{
+    const int kWarmup = 16;
+    StackType stack;
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<long long> poppedSum(0);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        long long localSum = 0;
+        long long base = static_cast<long long>(threadId) * (iterations + kWarmup);
+        for (int i = 0; i < kWarmup; i++)
+            stack.push(base + i);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < iterations; i++)
+        {
+            long long value;
+            stack.push(base + kWarmup + i);
+            if (stack.pop(value))
+                localSum += value;
+        }
+        poppedSum.fetch_add(localSum);
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    long long remainingSum = 0;
+    stack.pop_all([&](long long value) { remainingSum += value; });
+    long long totalPushed = static_cast<long long>(numThreads) * (iterations + kWarmup);
+    if (poppedSum.load() + remainingSum != totalPushed * (totalPushed - 1) / 2)
+        std::cout << "[testStackPerformance] Lost or duplicated elements!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+int main()
+{
+    int numReaders = 4;          // 讀者執行緒數量 / Number of reader threads
+    int numWriters = 4;          // 寫入者執行緒數量 / Number of writer threads
+    int swapIterations = 200000; // 每個寫入者的替換次數 / Swaps (retires) per writer
+
+    // 輸出格式設定 / Output formatting settings
+    const int widthLabel = 50;
+    const int widthTime  = 12;
+    std::cout << std::fixed << std::setprecision(6);
+
+    // ------ 記憶體回收測試：EBR vs 危險指標 / Reclamation Tests: EBR vs Hazard Pointers ------
+    std::cout << "\n=== Memory Reclamation Tests / 記憶體回收測試 ===\n\n";
+
+    ReclamationResult ebr = testReclamation<EpochDomain>(numReaders, numWriters, swapIterations, false);
+    ReclamationResult ebrStalled = testReclamation<EpochDomain>(numReaders, numWriters, swapIterations, true);
+    ReclamationResult hp = testReclamation<HazardPointerDomain>(numReaders, numWriters, swapIterations, false);
+    ReclamationResult hpStalled = testReclamation<HazardPointerDomain>(numReaders, numWriters, swapIterations, true);
+    const ReclamationResult* reclamationResults[] = { &ebr, &ebrStalled, &hp, &hpStalled };
+    const char* reclamationLabels[] = {
+        "EBR, all threads progressing / EBR，所有執行緒正常推進:",
+        "EBR, one stalled thread / EBR，一個執行緒停滯:",
+        "Hazard pointers, all threads progressing / 危險指標，所有執行緒正常推進:",
+        "Hazard pointers, one stalled thread / 危險指標，一個執行緒停滯:",
+    };
+    for (int i = 0; i < 4; i++)
+    {
+        const ReclamationResult& r = *reclamationResults[i];
+        std::cout << std::setw(widthLabel) << reclamationLabels[i] << "\n";
+        std::cout << std::setw(widthLabel) << "  Writer time / 寫入時間:" << std::setw(widthTime) << r.sec << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Retire throughput / retire 吞吐量:" << std::setw(widthTime) << r.retired / r.sec / 1e6 << " M ops/sec\n";
+        std::cout << std::setw(widthLabel) << "  Reads / 讀取速率:" << std::setw(widthTime) << r.reads / r.sec / 1e6 << " M reads/sec\n";
+        std::cout << std::setw(widthLabel) << "  Peak unreclaimed / 最大未釋放節點:" << std::setw(widthTime) << r.peakUnreclaimed << "\n";
+        std::cout << std::setw(widthLabel) << "  Corrupt reads / 讀到已釋放節點:" << std::setw(widthTime) << r.corruptReads << "\n\n";
+    }
+
+    // ------ 雜湊表測試 / Hash Map Tests ------
+    int numThreads = 8;          // 執行緒數量 / Number of threads
+    int mapIterations = 200000;  // 每個執行緒的操作次數 / Operations per thread
+    int keyRange = 100000;       // 鍵的範圍 / Key range
+    const int mapReadPercents[] = { 50, 90 };
+
+    std::cout << "\n=== Concurrent Hash Map Tests / 並行雜湊表測試 ===\n\n";
+    for (int readPercent : mapReadPercents)
+    {
+        StripedHashMap<std::uint64_t, std::uint64_t> striped;
+        GlobalLockHashMap<std::uint64_t, std::uint64_t, std::mutex> mutexMap;
+        GlobalLockHashMap<std::uint64_t, std::uint64_t, std::shared_mutex> sharedMutexMap;
+        prefillHashMap(striped, keyRange / 10);                 // 只填入 10%，測試期間會持續擴容
+        prefillHashMap(mutexMap, keyRange / 10);
+        prefillHashMap(sharedMutexMap, keyRange / 10);
+
+        double stripedTime = testHashMapPerformance(striped, numThreads, mapIterations, keyRange, readPercent, 0.0);
+        double mutexTime = testHashMapPerformance(mutexMap, numThreads, mapIterations, keyRange, readPercent, 0.0);
+        double sharedTime = testHashMapPerformance(sharedMutexMap, numThreads, mapIterations, keyRange, readPercent, 0.0);
+        std::string label = "find " + std::to_string(readPercent) + "% / 查詢 " + std::to_string(readPercent) + "%:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Striped buckets / 條帶鎖:" << std::setw(widthTime) << stripedTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  unordered_map + std::mutex / 單一互斥鎖:" << std::setw(widthTime) << mutexTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  unordered_map + std::shared_mutex / 單一共享鎖:" << std::setw(widthTime) << sharedTime << " sec\n\n";
+    }
+
+    // ------ 讀多寫少 Zipf 存取測試 / Read-heavy Zipfian Lookup Tests ------
+    int lookupReadPercent = 95;  // 查詢比例 / Lookup ratio
+    double zipfSkew = 0.99;      // Zipf 偏斜程度 / Zipf skew
+    const int threadCounts[] = { 1, 2, 4, 8 };
+
+    std::cout << "\n=== Read-heavy Zipfian Lookup Tests / 讀多寫少 Zipf 存取測試 ===\n\n";
+    for (int threads : threadCounts)
+    {
+        LockFreeReadHashMap lockFree;
+        StripedHashMap<std::uint64_t, std::uint64_t> striped;
+        GlobalLockHashMap<std::uint64_t, std::uint64_t, std::mutex> mutexMap;
+        prefillHashMap(lockFree, keyRange / 2);
+        prefillHashMap(striped, keyRange / 2);
+        prefillHashMap(mutexMap, keyRange / 2);
+
+        double lockFreeTime = testHashMapPerformance(lockFree, threads, mapIterations, keyRange, lookupReadPercent, zipfSkew);
+        double stripedTime = testHashMapPerformance(striped, threads, mapIterations, keyRange, lookupReadPercent, zipfSkew);
+        double mutexTime = testHashMapPerformance(mutexMap, threads, mapIterations, keyRange, lookupReadPercent, zipfSkew);
+        std::string label = std::to_string(threads) + " thread(s) / " + std::to_string(threads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Lock-free-read open addressing / 無鎖讀取開放定址:" << std::setw(widthTime) << lockFreeTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  Striped buckets / 條帶鎖:" << std::setw(widthTime) << stripedTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  unordered_map + std::mutex / 單一互斥鎖:" << std::setw(widthTime) << mutexTime << " sec\n\n";
+    }
+
+    // ------ 無鎖堆疊測試 / Lock-free Stack Tests ------
+    int stackIterations = 200000;   // 每個執行緒的 push/pop 輪數 / Push/pop rounds per thread
+    std::cout << "\n=== Lock-free Stack Tests / 無鎖堆疊測試 ===\n\n";
+    for (int threads : threadCounts)
+    {
+        double treiberTime = testStackPerformance<TreiberStack<long long>>(threads, stackIterations);
+        double mutexTime = testStackPerformance<MutexStack<long long>>(threads, stackIterations);
+        std::string label = std::to_string(threads) + " thread(s) / " + std::to_string(threads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Treiber stack + hazard pointers / 無鎖堆疊:" << std::setw(widthTime) << treiberTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  std::stack + std::mutex / 單一互斥鎖:" << std::setw(widthTime) << mutexTime << " sec\n\n";
+    }
+
+    return 0;   // 程式結束 / End program
+}
@@ -0,0 +1,1342 @@
+//------------------------------------------------------------------------------
+// 標頭檔說明 / Include Libraries Explanation:
+//
+// <iostream>           : 提供輸入輸出串流功能，用於 std::cout、std::endl 等.
+//                         Provides input/output stream functionality.
+//
+// <thread>             : 提供多執行緒支持，例如 std::thread、std::this_thread 等.
+//                         Provides multi-threading support.
+//
+// <mutex>              : 提供互斥鎖功能，用於保護佇列的頭尾與 std::cout.
+//                         Provides mutex functionality for the queue ends and std::cout.
+//
+// <condition_variable> : 提供條件變數，讓取出端在佇列為空時阻塞等待.
+//                         Provides condition variables for blocking consumers.
+//
+// <chrono>             : 提供計時與時間間隔功能，例如 sleep_for、high_resolution_clock.
+//                         Provides timing and duration functionalities.
+//
+// <vector>             : 提供動態陣列容器，用於儲存執行緒.
+//                         Provides dynamic array container (std::vector).
+//
+// <atomic>             : 提供原子操作類別，用於節點連結、槽位序號，以及 wait/notify（C++20）.
+//                         Provides atomics for node links, slot sequences and wait/notify (C++20).
+//
+// <iomanip>            : 提供格式化輸出功能，例如 std::setw、std::setprecision.
+//                         Provides formatting manipulators.
+//
+// <queue>              : 提供 std::queue，作為單一鎖保護的對照組.
+//                         Provides std::queue as the single-lock baseline.
+//
+// <string>             : 提供 std::string 與 std::to_string，用於組合輸出標籤.
+//                         Provides std::string and std::to_string for building output labels.
+//
+// <utility>            : 提供 std::move.
+//                         Provides std::move.
+//
+// <memory>             : 提供 std::unique_ptr，用於管理環狀緩衝區的槽位陣列.
+//                         Provides std::unique_ptr for owning the ring buffer slots.
+//
+// <cstdint>            : 提供固定寬度整數型別，例如 std::int64_t、std::uint32_t.
+//                         Provides fixed-width integer types.
+//
+// <algorithm>          : 提供 std::sort、std::min，用於計算延遲百分位數與批次大小.
+//                         Provides std::sort and std::min for percentiles and batch sizes.
+//
+// <deque>              : 提供 std::deque，作為通道的緩衝區.
+//                         Provides std::deque as the channel buffer.
+//
+// <pthread.h>, <sched.h> : (僅 Linux) 提供 pthread_setaffinity_np，將執行緒固定在指定核心.
+//                         (Linux only) Provides pthread_setaffinity_np for pinning threads to cores.
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <iomanip>
+#include <queue>
+#include <string>
+#include <utility>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 全域 mutex 用來保護 std::cout
+std::mutex cout_mutex;
+
+//===================================================================
+// 雙鎖無界佇列 / Two-lock Michael-Scott Queue
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// Michael & Scott 的雙鎖無界佇列
+///   head_ 永遠指向一個哨兵節點 (dummy)，真正的第一個元素是 head_->next
+///   push 只取 tailMutex_，pop 只取 headMutex_，生產者與消費者不會互相阻擋
+///   佇列只剩哨兵時，head_ 與 tail_ 指向同一節點，因此 next 需為原子變數
+/// 阻塞 pop：消費者先增加 waiters_ 再檢查 next；生產者先連結節點再讀取 waiters_，
+///   兩者皆為 seq_cst，因此「消費者看到新節點」或「生產者看到等待者」至少成立一個，不會遺失喚醒
+/// close() 之後 push 一律失敗；pop 取完剩餘元素後回傳 false
+/// Two-lock unbounded queue: producers and consumers take different locks.
+template<typename T>
+class TwoLockQueue
+{
+public:
+    TwoLockQueue() : head_(new Node), tail_(head_) {}
+
+    ~TwoLockQueue()
+    {
+        while (head_ != nullptr)
+        {
+            Node* next = head_->next.load(std::memory_order_relaxed);
+            delete head_;
+            head_ = next;
+        }
+    }
+
+    TwoLockQueue(const TwoLockQueue&) = delete;
+    TwoLockQueue& operator=(const TwoLockQueue&) = delete;
+
+    /// 放入一個元素；佇列已關閉時回傳 false
+    bool push(T value)
+    {
+        Node* node = new Node;
+        node->value = std::move(value);
+        {
+            std::lock_guard<std::mutex> lock(tailMutex_);
+            if (closed_.load(std::memory_order_relaxed))
+            {
+                delete node;
+                return false;
+            }
+            tail_->next.store(node);
+            tail_ = node;
+        }
+        if (waiters_.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(headMutex_);
+            notEmpty_.notify_one();
+        }
+        return true;
+    }
+
+    /// 不阻塞地取出一個元素；佇列為空時回傳 false
+    bool try_pop(T& out)
+    {
+        std::lock_guard<std::mutex> lock(headMutex_);
+        return popLocked(out);
+    }
+
+    /// 阻塞直到取得元素；佇列已關閉且為空時回傳 false
+    bool pop(T& out)
+    {
+        std::unique_lock<std::mutex> lock(headMutex_);
+        while (!popLocked(out))
+        {
+            if (closed_.load())
+                return popLocked(out);
+            waiters_.fetch_add(1);
+            if (head_->next.load() == nullptr && !closed_.load())
+                notEmpty_.wait(lock);
+            waiters_.fetch_sub(1);
+        }
+        return true;
+    }
+
+    /// 關閉佇列並喚醒所有等待中的消費者
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(tailMutex_);
+            closed_.store(true);
+        }
+        std::lock_guard<std::mutex> lock(headMutex_);
+        notEmpty_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(); }
+
+private:
+    struct Node
+    {
+        T value{};
+        std::atomic<Node*> next{ nullptr };
+    };
+
+    /// 呼叫端需持有 headMutex_；取出後舊的哨兵被釋放，第一個節點成為新哨兵
+    bool popLocked(T& out)
+    {
+        Node* first = head_->next.load();
+        if (first == nullptr)
+            return false;
+        out = std::move(first->value);
+        Node* oldDummy = head_;
+        head_ = first;
+        delete oldDummy;
+        return true;
+    }
+
+    // 頭尾各佔一條快取行，避免生產者與消費者互相干擾 (false sharing)
+    alignas(64) std::mutex headMutex_;
+    Node* head_;
+    std::condition_variable notEmpty_;
+    std::atomic<int> waiters_{ 0 };
+    alignas(64) std::mutex tailMutex_;
+    Node* tail_;
+    std::atomic<bool> closed_{ false };
+};
+
+/// -----------------------------------------------------------------
+/// 對照組：std::queue 以單一 std::mutex 與條件變數保護
+/// Baseline: std::queue guarded by a single mutex and condition variable.
+template<typename T>
+class MutexQueue
+{
+public:
+    bool push(T value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_)
+                return false;
+            queue_.push(std::move(value));
+        }
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool try_pop(T& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty())
+            return false;
+        out = std::move(queue_.front());
+        queue_.pop();
+        return true;
+    }
+
+    bool pop(T& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !queue_.empty() || closed_; });
+        if (queue_.empty())
+            return false;
+        out = std::move(queue_.front());
+        queue_.pop();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+    }
+
+    bool closed() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::queue<T> queue_;
+    bool closed_ = false;
+};
+
+//===================================================================
+// 有界無鎖 MPMC 環狀佇列 / Bounded Lock-free MPMC Ring Buffer (Vyukov)
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// Dmitry Vyukov 的有界多生產者多消費者佇列
+///   每個槽位有一個序號 sequence，初始為槽位索引 i
+///   push：在位置 pos 看到 sequence == pos 代表槽位空閒，CAS 推進 enqueuePos_ 後寫入資料，
+///         再將 sequence 設為 pos + 1 通知消費者
+///   pop ：在位置 pos 看到 sequence == pos + 1 代表資料就緒，CAS 推進 dequeuePos_ 後讀出資料，
+///         再將 sequence 設為 pos + capacity，讓下一輪的生產者使用
+///   建構後不再配置記憶體；容量會向上取到 2 的次方，以位元遮罩取代取餘數
+/// 阻塞版本：先短暫自旋，之後以 C++20 std::atomic::wait 睡眠（Linux 上即為 futex）
+///   等待者先增加等待計數再重試；通知端完成操作後檢查等待計數，
+///   兩邊各以一道 seq_cst fence 隔開，因此不會遺失喚醒，也不會在無人等待時呼叫 notify
+/// Vyukov bounded MPMC queue with per-slot sequence numbers and futex-based blocking.
+template<typename T>
+class BoundedMpmcQueue
+{
+public:
+    explicit BoundedMpmcQueue(std::size_t capacity = 1024)
+        : mask_(roundUpToPowerOfTwo(capacity) - 1),
+          cells_(new Cell[mask_ + 1])
+    {
+        for (std::size_t i = 0; i <= mask_; i++)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+    /// 不阻塞地放入一個元素；佇列已滿時回傳 false
+    bool try_push(const T& value)
+    {
+        Cell* cell;
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;   // 這個槽位還有上一輪的資料：佇列已滿
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        wake(pushEvents_, waitingPoppers_);
+        return true;
+    }
+
+    /// 不阻塞地取出一個元素；佇列為空時回傳 false
+    bool try_pop(T& out)
+    {
+        Cell* cell;
+        std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;   // 生產者尚未寫入：佇列為空
+            else
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+        out = cell->value;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        wake(popEvents_, waitingPushers_);
+        return true;
+    }
+
+    /// 阻塞直到放入成功（永遠回傳 true，介面與其他佇列一致）
+    bool push(const T& value)
+    {
+        block([&] { return try_push(value); }, popEvents_, waitingPushers_);
+        return true;
+    }
+
+    /// 阻塞直到取得元素（永遠回傳 true；結束消費者請放入毒丸訊息）
+    bool pop(T& out)
+    {
+        block([&] { return try_pop(out); }, pushEvents_, waitingPoppers_);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence{ 0 };
+        T value{};
+    };
+
+    static constexpr int kSpinCount = 64;   // 睡眠前自旋重試的次數 / Retries before sleeping
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n)
+    {
+        std::size_t result = 2;
+        while (result < n)
+            result <<= 1;
+        return result;
+    }
+
+    /// 反覆嘗試 attempt()；自旋 kSpinCount 次仍失敗就在 events 上等待
+    template<typename Attempt>
+    static void block(Attempt&& attempt, std::atomic<std::uint32_t>& events, std::atomic<int>& waiting)
+    {
+        for (int spin = 0; ; spin++)
+        {
+            if (attempt())
+                return;
+            if (spin < kSpinCount)
+                continue;
+            std::uint32_t ticket = events.load();
+            waiting.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (attempt())
+            {
+                waiting.fetch_sub(1);
+                return;
+            }
+            events.wait(ticket);   // ticket 之後若有人 wake，會立即返回
+            waiting.fetch_sub(1);
+        }
+    }
+
+    /// 完成一次 push / pop 後呼叫：只有在對方有人等待時才推進事件計數並喚醒
+    static void wake(std::atomic<std::uint32_t>& events, std::atomic<int>& waiting)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0)
+        {
+            events.fetch_add(1);
+            events.notify_one();
+        }
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // 生產端與消費端的索引各佔一條快取行，避免 false sharing
+    alignas(64) std::atomic<std::size_t> enqueuePos_{ 0 };
+    std::atomic<std::uint32_t> popEvents_{ 0 };     // 有槽位被釋出時推進，喚醒等待中的生產者
+    std::atomic<int> waitingPushers_{ 0 };
+    alignas(64) std::atomic<std::size_t> dequeuePos_{ 0 };
+    std::atomic<std::uint32_t> pushEvents_{ 0 };    // 有資料被放入時推進，喚醒等待中的消費者
+    std::atomic<int> waitingPoppers_{ 0 };
+};
+
+//===================================================================
+// 單生產者單消費者環狀緩衝區 / Wait-free SPSC Ring Buffer
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 單生產者單消費者 (SPSC) 環狀緩衝區
+///   tail_ 只由生產者寫入，head_ 只由消費者寫入，兩者皆單調遞增，以 index & mask_ 取得槽位
+///   每一端保留對方索引的快取 (cachedHead_ / cachedTail_)，只有在快取顯示已滿 / 已空時
+///   才重新讀取對方的原子變數，因此大部分操作不會讀到對方所在的快取行
+///   每個操作都在固定步數內完成，不需要 CAS 或重試，是 wait-free 的
+/// 批次 API 一次搬移多個元素，但只發佈一次索引，分攤原子操作的成本
+/// Wait-free SPSC ring with cached peer indices and batch push/pop.
+template<typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t capacity = 1024)
+        : mask_(roundUpToPowerOfTwo(capacity) - 1),
+          buffer_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// 僅限生產者呼叫；已滿時回傳 false
+    bool try_push(const T& value)
+    {
+        return push_batch(&value, 1) == 1;
+    }
+
+    /// 僅限消費者呼叫；為空時回傳 false
+    bool try_pop(T& out)
+    {
+        return pop_batch(&out, 1) == 1;
+    }
+
+    /// 僅限生產者呼叫：放入至多 count 個元素，回傳實際放入的數量
+    std::size_t push_batch(const T* items, std::size_t count)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t capacity = mask_ + 1;
+        if (capacity - (tail - cachedHead_) < count)
+            cachedHead_ = head_.load(std::memory_order_acquire);   // 快取顯示空間不足時才重新讀取
+        std::size_t n = std::min(count, capacity - (tail - cachedHead_));
+        for (std::size_t i = 0; i < n; i++)
+            buffer_[(tail + i) & mask_] = items[i];
+        if (n > 0)
+            tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// 僅限消費者呼叫：取出至多 maxCount 個元素，回傳實際取出的數量
+    std::size_t pop_batch(T* out, std::size_t maxCount)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ - head < maxCount)
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+        std::size_t n = std::min(maxCount, cachedTail_ - head);
+        for (std::size_t i = 0; i < n; i++)
+            out[i] = buffer_[(head + i) & mask_];
+        if (n > 0)
+            head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t n)
+    {
+        std::size_t result = 2;
+        while (result < n)
+            result <<= 1;
+        return result;
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+    // 消費者擁有的資料放在同一條快取行，生產者擁有的放在另一條
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+    std::size_t cachedTail_ = 0;
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    std::size_t cachedHead_ = 0;
+};
+
+//===================================================================
+// Go 風格通道與 select / Go-style Channels with select
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// select 的等待者：select 在每個通道登記同一個等待者，任一通道有資料或關閉時將 ready 設為 true
+/// A waiter registered by select() on every channel it listens to.
+struct SelectWaiter
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool ready = false;
+
+    void signal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready = true;
+        }
+        cv.notify_one();
+    }
+};
+
+/// -----------------------------------------------------------------
+/// Go 風格的通道，每個通道有自己的 mutex，沒有任何全域鎖
+///   capacity > 0：有緩衝通道，緩衝區未滿時 send 立即返回
+///   capacity == 0：無緩衝通道，send 會等到接收端真正取走資料才返回（rendezvous）
+///   close() 之後 send 回傳 false；recv 取完剩餘資料後回傳 false
+/// 鎖的順序固定為「通道 mutex → 等待者 mutex」，select 不會同時持有兩個通道的鎖
+/// Per-channel mutex; unbuffered sends wait until the value is received.
+template<typename T>
+class Channel
+{
+public:
+    explicit Channel(std::size_t capacity = 0) : capacity_(capacity) {}
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    /// 送出一個值；通道已關閉時回傳 false
+    bool send(T value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        canSend_.wait(lock, [this] { return closed_ || buffer_.size() < slotCount(); });
+        if (closed_)
+            return false;
+        buffer_.push_back(std::move(value));
+        std::uint64_t ticket = ++sent_;
+        canRecv_.notify_one();
+        notifySelectWaiters();
+        if (capacity_ == 0)   // 無緩衝：等到接收端取走這個值
+            canSend_.wait(lock, [&] { return received_ >= ticket || closed_; });
+        return true;
+    }
+
+    /// 阻塞直到收到一個值；通道已關閉且為空時回傳 false
+    bool recv(T& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        canRecv_.wait(lock, [this] { return closed_ || !buffer_.empty(); });
+        return takeLocked(out);
+    }
+
+    /// 不阻塞地接收；沒有資料時回傳 false
+    bool try_recv(T& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return takeLocked(out);
+    }
+
+    /// 關閉通道並喚醒所有等待中的傳送端、接收端與 select
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        canSend_.notify_all();
+        canRecv_.notify_all();
+        notifySelectWaiters();
+    }
+
+    /// 已關閉且緩衝區已清空：之後不會再有資料
+    bool drained() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_ && buffer_.empty();
+    }
+
+    /// 供 select 使用：登記等待者；若此時已有資料或已關閉則回傳 true，呼叫端不需等待
+    bool addSelectWaiter(SelectWaiter* waiter)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        selectWaiters_.push_back(waiter);
+        return closed_ || !buffer_.empty();
+    }
+
+    void removeSelectWaiter(SelectWaiter* waiter)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        selectWaiters_.erase(std::remove(selectWaiters_.begin(), selectWaiters_.end(), waiter), selectWaiters_.end());
+    }
+
+private:
+    /// 無緩衝通道也保留一個槽位，讓傳送端放入值後等待接收端取走
+    std::size_t slotCount() const { return capacity_ == 0 ? 1 : capacity_; }
+
+    bool takeLocked(T& out)
+    {
+        if (buffer_.empty())
+            return false;
+        out = std::move(buffer_.front());
+        buffer_.pop_front();
+        ++received_;
+        if (capacity_ == 0)
+            canSend_.notify_all();   // 同時喚醒等待取走的傳送端與等待槽位的傳送端
+        else
+            canSend_.notify_one();
+        return true;
+    }
+
+    void notifySelectWaiters()
+    {
+        for (SelectWaiter* waiter : selectWaiters_)
+            waiter->signal();
+    }
+
+    const std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable canSend_;
+    std::condition_variable canRecv_;
+    std::deque<T> buffer_;
+    std::uint64_t sent_ = 0;
+    std::uint64_t received_ = 0;
+    bool closed_ = false;
+    std::vector<SelectWaiter*> selectWaiters_;
+};
+
+constexpr int kSelectTimeout = -1;   // 逾時前沒有任何通道有資料
+constexpr int kSelectClosed = -2;    // 所有通道都已關閉且清空
+
+/// -----------------------------------------------------------------
+/// 在多個通道上等待接收，回傳收到資料的通道索引，或 kSelectTimeout / kSelectClosed
+///   1. 依序嘗試每個通道（起點輪替，避免總是偏好第一個通道）
+///   2. 都沒有資料時，在每個通道登記同一個等待者；登記時若發現已有資料就不睡眠
+///   3. 等待直到被喚醒或逾時，之後從所有通道移除等待者再重試
+/// 每次只鎖一個通道，因此不需要全域鎖，也不會因鎖的順序而死結
+/// timeout 為負值時無限期等待
+/// Waits on several channels with an optional timeout, without a global lock.
+template<typename T>
+int selectRecv(const std::vector<Channel<T>*>& channels, T& out,
+               std::chrono::milliseconds timeout = std::chrono::milliseconds(-1))
+{
+    thread_local std::size_t rotation = 0;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    SelectWaiter waiter;
+    std::size_t count = channels.size();
+    for (;;)
+    {
+        std::size_t start = rotation++;
+        std::size_t drainedCount = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::size_t index = (start + i) % count;
+            if (channels[index]->try_recv(out))
+                return static_cast<int>(index);
+            if (channels[index]->drained())
+                drainedCount++;
+        }
+        if (drainedCount == count)
+            return kSelectClosed;
+
+        waiter.ready = false;   // 尚未登記，沒有其他執行緒會存取 waiter
+        bool readyNow = false;
+        for (Channel<T>* channel : channels)
+            readyNow = channel->addSelectWaiter(&waiter) || readyNow;
+        bool timedOut = false;
+        if (!readyNow)
+        {
+            std::unique_lock<std::mutex> lock(waiter.mutex);
+            if (timeout.count() < 0)
+                waiter.cv.wait(lock, [&] { return waiter.ready; });
+            else
+                timedOut = !waiter.cv.wait_until(lock, deadline, [&] { return waiter.ready; });
+        }
+        for (Channel<T>* channel : channels)
+            channel->removeSelectWaiter(&waiter);
+        if (timedOut)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (channels[i]->try_recv(out))
+                    return static_cast<int>(i);
+            }
+            return kSelectTimeout;
+        }
+    }
+}
+
+/// -----------------------------------------------------------------
+/// 以通道回報進度的 helperTask（對應 Lesson 1 的 helperTask）
+/// Lesson 1's helperTask, reporting progress over a channel instead of std::cout.
+void helperTask(Channel<std::string>& progress)
+{
+    for (int i = 0; i < 5; ++i)
+    {
+        progress.send("[Helper] Running, iteration " + std::to_string(i));
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    progress.close();
+}
+
+/// -----------------------------------------------------------------
+/// 以通道回報狀態的 backgroundTask（對應 Lesson 1 的 backgroundTask）
+/// Lesson 1's backgroundTask, reporting its start and finish over a channel.
+void backgroundTask(Channel<std::string>& status)
+{
+    status.send("[backgroundTask] Background thread started.");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    status.send("[backgroundTask] Background thread finished.");
+    status.close();
+}
+
+/// -----------------------------------------------------------------
+/// 對照組：以單一 mutex 與 condition_variable 交接一個值
+/// Baseline: one-slot hand-off with a mutex and a condition variable.
+template<typename T>
+class CondVarHandoff
+{
+public:
+    void send(T value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !full_; });
+        value_ = std::move(value);
+        full_ = true;
+        cv_.notify_all();
+    }
+
+    void recv(T& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return full_; });
+        out = std::move(value_);
+        full_ = false;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    T value_{};
+    bool full_ = false;
+};
+
+//===================================================================
+// 以佇列串流任務給工作執行緒 / Streaming Tasks to Worker Threads
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 一筆工作項目，對應 Lesson 1 中 basicTask(id, value) 的參數
+struct WorkItem
+{
+    int id = 0;
+    int value = 0;
+};
+
+/// -----------------------------------------------------------------
+/// 基本任務函式 / Basic Task Function（與 Lesson 1 相同，延遲縮短為 20ms）
+/// Same as Lesson 1's basicTask, with a shorter simulated delay.
+void basicTask(int id, int value)
+{
+    {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cout << "[basicTask] Thread id: " << std::this_thread::get_id()
+                  << ", Task id: " << id << ", value: " << value << std::endl;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+/// -----------------------------------------------------------------
+/// 工作執行緒：持續從佇列取出工作並執行 basicTask，直到佇列關閉且清空
+/// Worker loop: runs basicTask for every streamed item until the queue is closed and drained.
+void basicTaskWorker(TwoLockQueue<WorkItem>& queue)
+{
+    WorkItem item;
+    while (queue.pop(item))
+        basicTask(item.id, item.value);
+}
+
+//===================================================================
+// 佇列效能測試 / Queue Performance Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 生產者 / 消費者吞吐量測試
+///   每個生產者放入 itemsPerProducer 個元素；消費者以阻塞 pop 取出直到佇列關閉
+///   所有生產者結束後由主執行緒關閉佇列；檢查取出的總和，確保沒有遺失或重複
+/// Returns elapsed seconds from start until every item is consumed.
+template<typename QueueType>
+double testQueuePerformance(int numProducers, int numConsumers, int itemsPerProducer)
+{
+    QueueType queue;
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<long long> consumedSum(0);
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+    producers.reserve(numProducers);
+    consumers.reserve(numConsumers);
+
+    auto producerFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < itemsPerProducer; i++)
+            queue.push(threadId * itemsPerProducer + i);
+    };
+
+    auto consumerFunc = [&]()
+    {
+        long long localSum = 0;
+        int value;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        while (queue.pop(value))
+            localSum += value;
+        consumedSum.fetch_add(localSum);
+    };
+
+    for (int i = 0; i < numProducers; i++)
+        producers.emplace_back(producerFunc, i);
+    for (int i = 0; i < numConsumers; i++)
+        consumers.emplace_back(consumerFunc);
+
+    while (readyCount.load() < numProducers + numConsumers)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : producers)
+         th.join();
+    queue.close();
+    for (auto &th : consumers)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    long long totalItems = static_cast<long long>(numProducers) * itemsPerProducer;
+    if (consumedSum.load() != totalItems * (totalItems - 1) / 2)
+    {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cout << "[testQueuePerformance] Lost or duplicated items!" << std::endl;
+    }
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 吞吐量與延遲測試結果
+struct QueueLatencyResult
+{
+    double sec = 0.0;         // 全部訊息送達所花的時間
+    double p50Micros = 0.0;   // 從 push 到 pop 的延遲百分位數（微秒）
+    double p99Micros = 0.0;
+    double p999Micros = 0.0;
+};
+
+/// -----------------------------------------------------------------
+/// 生產者 / 消費者延遲測試
+///   每則訊息是 push 當下的時間戳（奈秒），消費者取出後計算延遲並記錄
+///   所有生產者結束後放入 numConsumers 個毒丸訊息 (-1) 結束消費者，
+///   因此不需要 close()，可同時測試沒有關閉語意的有界佇列
+/// Measures throughput and push-to-pop latency percentiles; consumers stop on poison messages.
+template<typename QueueType>
+QueueLatencyResult testQueueLatency(int numProducers, int numConsumers, int totalItems)
+{
+    const std::int64_t kPoison = -1;
+    QueueType queue;
+    int itemsPerProducer = totalItems / numProducers;
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::vector<std::int64_t>> latencies(numConsumers);
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+    producers.reserve(numProducers);
+    consumers.reserve(numConsumers);
+
+    auto nowNanos = []()
+    {
+        return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    };
+
+    auto producerFunc = [&]()
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < itemsPerProducer; i++)
+            queue.push(nowNanos());
+    };
+
+    auto consumerFunc = [&](int threadId)
+    {
+        std::vector<std::int64_t>& samples = latencies[threadId];
+        std::size_t fairShare = static_cast<std::size_t>(itemsPerProducer) * numProducers / numConsumers;
+        samples.reserve(fairShare + fairShare / 4);             // 平均份額再留 25%，分配不均時由 vector 自行成長
+        std::int64_t sendTime;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        while (queue.pop(sendTime) && sendTime != kPoison)
+            samples.push_back(nowNanos() - sendTime);
+    };
+
+    for (int i = 0; i < numProducers; i++)
+        producers.emplace_back(producerFunc);
+    for (int i = 0; i < numConsumers; i++)
+        consumers.emplace_back(consumerFunc, i);
+
+    while (readyCount.load() < numProducers + numConsumers)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : producers)
+         th.join();
+    for (int i = 0; i < numConsumers; i++)
+        queue.push(kPoison);
+    for (auto &th : consumers)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::int64_t> all;
+    for (const auto& samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+
+    QueueLatencyResult result;
+    result.sec = std::chrono::duration<double>(endTime - startTime).count();
+    if (!all.empty())
+    {
+        auto percentile = [&](double p) { return all[static_cast<std::size_t>(p * (all.size() - 1))] / 1000.0; };
+        result.p50Micros = percentile(0.50);
+        result.p99Micros = percentile(0.99);
+        result.p999Micros = percentile(0.999);
+    }
+    if (static_cast<long long>(all.size()) != static_cast<long long>(itemsPerProducer) * numProducers)
+    {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cout << "[testQueueLatency] Lost or duplicated items!" << std::endl;
+    }
+    return result;
+}
+
+/// -----------------------------------------------------------------
+/// 將目前執行緒固定在指定的 CPU 上（僅 Linux）；cpu < 0 或不支援時回傳 false
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0)
+        return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/// -----------------------------------------------------------------
+/// SPSC 管線測試
+///   生產者以 batchSize 為單位放入帶有時間戳的訊息，消費者以相同的批次大小取出並記錄延遲
+///   兩個執行緒分別固定在 producerCpu / consumerCpu；兩者相同時即為同核心測試
+///   環狀緩衝區已滿 / 已空時讓出 CPU，讓同核心的另一端有機會執行
+///   無法固定 CPU（CPU 不足、affinity 遮罩限制或非 Linux）時照常測試，但會印出提示，結果代表未固定的執行緒
+/// Measures messages/sec and per-message latency through an SpscRing with pinned threads.
+QueueLatencyResult testSpscPerformance(int messages, int batchSize, int producerCpu, int consumerCpu)
+{
+    SpscRing<std::int64_t> ring(1024);
+    std::vector<std::int64_t> samples;
+    samples.reserve(messages);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<bool> pinFailed(false);
+
+    auto nowNanos = []()
+    {
+        return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    };
+
+    std::thread producer([&]()
+    {
+        if (!pinCurrentThread(producerCpu))
+            pinFailed = true;
+        std::vector<std::int64_t> batch(batchSize);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int sent = 0; sent < messages; )
+        {
+            std::size_t count = std::min(batchSize, messages - sent);
+            std::int64_t now = nowNanos();
+            for (std::size_t i = 0; i < count; i++)
+                batch[i] = now;
+            std::size_t done = 0;
+            while (done < count)
+            {
+                std::size_t pushed = ring.push_batch(batch.data() + done, count - done);
+                if (pushed == 0)
+                    std::this_thread::yield();
+                done += pushed;
+            }
+            sent += static_cast<int>(count);
+        }
+    });
+
+    std::thread consumer([&]()
+    {
+        if (!pinCurrentThread(consumerCpu))
+            pinFailed = true;
+        std::vector<std::int64_t> batch(batchSize);
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int received = 0; received < messages; )
+        {
+            std::size_t popped = ring.pop_batch(batch.data(), batchSize);
+            if (popped == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::int64_t now = nowNanos();
+            for (std::size_t i = 0; i < popped; i++)
+                samples.push_back(now - batch[i]);
+            received += static_cast<int>(popped);
+        }
+    });
+
+    while (readyCount.load() < 2)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    producer.join();
+    consumer.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (pinFailed)
+    {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cout << "[testSpscPerformance] Could not pin threads to CPU " << producerCpu << " / " << consumerCpu
+                  << ", results below are unpinned!" << std::endl;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    QueueLatencyResult result;
+    result.sec = std::chrono::duration<double>(endTime - startTime).count();
+    auto percentile = [&](double p) { return samples[static_cast<std::size_t>(p * (samples.size() - 1))] / 1000.0; };
+    result.p50Micros = percentile(0.50);
+    result.p99Micros = percentile(0.99);
+    result.p999Micros = percentile(0.999);
+    return result;
+}
+
+/// -----------------------------------------------------------------
+/// 乒乓延遲測試：一個執行緒經由 ping 送出值，另一個執行緒收到後經由 pong 送回
+/// 回傳完成 roundTrips 次往返所花的秒數
+/// Ping-pong between two threads; PipeType is Channel<int> or CondVarHandoff<int>.
+template<typename PipeType>
+double testPingPongPerformance(PipeType& ping, PipeType& pong, int roundTrips)
+{
+    std::thread echo([&]()
+    {
+        int value = 0;
+        for (int i = 0; i < roundTrips; i++)
+        {
+            ping.recv(value);
+            pong.send(value + 1);
+        }
+    });
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    int value = 0;
+    for (int i = 0; i < roundTrips; i++)
+    {
+        ping.send(value);
+        pong.recv(value);
+    }
+    echo.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (value != roundTrips)
+        std::cout << "[testPingPongPerformance] Lost messages!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 匯流 (fan-in) 吞吐量測試：numProducers 個生產者，一個消費者
+///   fanInMode = 0：每個生產者有自己的有緩衝通道，消費者以 selectRecv 同時等待所有通道
+///   fanInMode = 1：所有生產者共用一個有緩衝通道
+///   fanInMode = 2：所有生產者共用 MutexQueue（mutex + condition_variable）
+/// Fan-in of numProducers streams into one consumer.
+double testFanInPerformance(int numProducers, int itemsPerProducer, int fanInMode)
+{
+    const std::size_t kChannelCapacity = 1024;
+    std::vector<std::unique_ptr<Channel<int>>> ownChannels;
+    std::vector<Channel<int>*> selectSet;
+    for (int i = 0; i < numProducers; i++)
+    {
+        ownChannels.push_back(std::make_unique<Channel<int>>(kChannelCapacity));
+        selectSet.push_back(ownChannels.back().get());
+    }
+    Channel<int> sharedChannel(kChannelCapacity);
+    MutexQueue<int> sharedQueue;
+
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> producers;
+    producers.reserve(numProducers);
+
+    auto producerFunc = [&](int threadId)
+    {
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < itemsPerProducer; i++)
+        {
+            if (fanInMode == 0)
+                ownChannels[threadId]->send(1);
+            else if (fanInMode == 1)
+                sharedChannel.send(1);
+            else
+                sharedQueue.push(1);
+        }
+        if (fanInMode == 0)
+            ownChannels[threadId]->close();
+    };
+
+    long long total = 0;
+    std::thread consumer([&]()
+    {
+        int value;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        if (fanInMode == 0)
+        {
+            while (selectRecv(selectSet, value) >= 0)
+                total += value;
+        }
+        else if (fanInMode == 1)
+        {
+            while (sharedChannel.recv(value))
+                total += value;
+        }
+        else
+        {
+            while (sharedQueue.pop(value))
+                total += value;
+        }
+    });
+
+    for (int i = 0; i < numProducers; i++)
+        producers.emplace_back(producerFunc, i);
+
+    while (readyCount.load() < numProducers + 1)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : producers)
+         th.join();
+    sharedChannel.close();
+    sharedQueue.close();
+    consumer.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (total != static_cast<long long>(numProducers) * itemsPerProducer)
+        std::cout << "[testFanInPerformance] Lost or duplicated items!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+int main()
+{
+    // 輸出格式設定 / Output formatting settings
+    const int widthLabel = 50;
+    const int widthTime  = 12;
+
+    // ------ 以佇列串流任務 / Streaming Tasks through a Queue ------
+    std::cout << "\n=== Producer/Consumer basicTask / 生產者消費者 basicTask ===\n\n";
+    {
+        TwoLockQueue<WorkItem> workQueue;
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 2; i++)
+            workers.emplace_back(basicTaskWorker, std::ref(workQueue));
+
+        // 工作執行緒已在運行，主執行緒持續送入新任務
+        for (int id = 1; id <= 6; id++)
+            workQueue.push(WorkItem{ id, id * 100 });
+        workQueue.close();
+        for (auto &th : workers)
+             th.join();
+    }
+
+    // ------ 以通道協調背景任務 / Coordinating Background Tasks with Channels ------
+    std::cout << "\n=== Channels and select / 通道與 select ===\n\n";
+    {
+        Channel<std::string> progress;       // 無緩衝 / Unbuffered
+        Channel<std::string> status(2);      // 有緩衝 / Buffered
+        std::thread helper(helperTask, std::ref(progress));
+        std::thread background(backgroundTask, std::ref(status));
+
+        std::vector<Channel<std::string>*> sources = { &progress, &status };
+        std::string message;
+        for (;;)
+        {
+            int index = selectRecv(sources, message, std::chrono::milliseconds(20));
+            if (index == kSelectClosed)
+                break;
+            if (index == kSelectTimeout)
+                std::cout << "[Main] No message within 20 ms, still waiting..." << std::endl;
+            else
+                std::cout << "[Main] From channel " << index << ": " << message << std::endl;
+        }
+        helper.join();
+        background.join();
+    }
+
+    // ------ 佇列吞吐量測試 / Queue Throughput Tests ------
+    int itemsPerProducer = 200000;  // 每個生產者放入的元素數 / Items pushed per producer
+    const int threadPairs[] = { 1, 2, 4 };
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "\n=== Queue Throughput Tests / 佇列吞吐量測試 ===\n\n";
+    for (int pairs : threadPairs)
+    {
+        double twoLockTime = testQueuePerformance<TwoLockQueue<int>>(pairs, pairs, itemsPerProducer);
+        double mutexTime = testQueuePerformance<MutexQueue<int>>(pairs, pairs, itemsPerProducer);
+        double totalItems = static_cast<double>(pairs) * itemsPerProducer;
+        std::string label = std::to_string(pairs) + " producer(s) + " + std::to_string(pairs) + " consumer(s) / "
+                          + std::to_string(pairs) + " 生產者 + " + std::to_string(pairs) + " 消費者:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Two-lock queue / 雙鎖佇列:" << std::setw(widthTime) << twoLockTime << " sec"
+                  << std::setw(widthTime) << totalItems / twoLockTime / 1e6 << " M items/sec\n";
+        std::cout << std::setw(widthLabel) << "  std::queue + std::mutex / 單一互斥鎖:" << std::setw(widthTime) << mutexTime << " sec"
+                  << std::setw(widthTime) << totalItems / mutexTime / 1e6 << " M items/sec\n\n";
+    }
+
+    // ------ 有界 MPMC 佇列延遲測試 / Bounded MPMC Queue Latency Tests ------
+    int latencyItems = 400000;      // 所有生產者合計放入的訊息數 / Messages pushed by all producers
+    const int latencyPairs[] = { 1, 2, 4, 8, 16, 32 };
+    const char* queueLabels[] = {
+        "  Vyukov bounded MPMC / 有界無鎖 MPMC:",
+        "  Two-lock queue / 雙鎖佇列:",
+        "  std::queue + mutex + condvar / 互斥鎖與條件變數:",
+    };
+
+    std::cout << "\n=== MPMC Queue Latency Tests / MPMC 佇列延遲測試 ===\n\n";
+    for (int pairs : latencyPairs)
+    {
+        QueueLatencyResult results[] = {
+            testQueueLatency<BoundedMpmcQueue<std::int64_t>>(pairs, pairs, latencyItems),
+            testQueueLatency<TwoLockQueue<std::int64_t>>(pairs, pairs, latencyItems),
+            testQueueLatency<MutexQueue<std::int64_t>>(pairs, pairs, latencyItems),
+        };
+        std::string label = std::to_string(pairs) + " producer(s) + " + std::to_string(pairs) + " consumer(s) / "
+                          + std::to_string(pairs) + " 生產者 + " + std::to_string(pairs) + " 消費者:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        for (int i = 0; i < 3; i++)
+        {
+            const QueueLatencyResult& r = results[i];
+            std::cout << std::setw(widthLabel) << queueLabels[i] << std::setw(widthTime) << latencyItems / r.sec / 1e6 << " M items/sec"
+                      << std::setprecision(1) << "  p50 " << r.p50Micros << " us, p99 " << r.p99Micros
+                      << " us, p99.9 " << r.p999Micros << " us\n" << std::setprecision(6);
+        }
+        std::cout << "\n";
+    }
+
+    // ------ SPSC 管線測試 / SPSC Pipeline Tests ------
+    int spscMessages = 2000000;     // 傳遞的訊息數 / Messages sent through the ring
+    const int batchSizes[] = { 1, 32 };
+    bool haveSecondCore = std::thread::hardware_concurrency() >= 2;
+
+    std::cout << "\n=== SPSC Ring Buffer Tests / SPSC 環狀緩衝區測試 ===\n\n";
+    for (int batchSize : batchSizes)
+    {
+        std::string label = "batch size " + std::to_string(batchSize) + " / 批次大小 " + std::to_string(batchSize) + ":";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        for (int placement = 0; placement < 2; placement++)
+        {
+            const char* placementLabel = placement == 0 ? "  Same core / 同一核心:" : "  Different cores / 不同核心:";
+            if (placement == 1 && !haveSecondCore)
+            {
+                std::cout << std::setw(widthLabel) << placementLabel << "  skipped (only one core) / 略過（只有一個核心）\n";
+                continue;
+            }
+            QueueLatencyResult r = testSpscPerformance(spscMessages, batchSize, 0, placement);
+            std::cout << std::setw(widthLabel) << placementLabel << std::setw(widthTime) << spscMessages / r.sec / 1e6 << " M msgs/sec"
+                      << std::setprecision(1) << "  p50 " << r.p50Micros << " us, p99 " << r.p99Micros
+                      << " us, p99.9 " << r.p999Micros << " us\n" << std::setprecision(6);
+        }
+        std::cout << "\n";
+    }
+
+    // ------ 通道效能測試 / Channel Performance Tests ------
+    int roundTrips = 50000;          // 乒乓往返次數 / Ping-pong round trips
+    std::cout << "\n=== Channel Ping-pong Tests / 通道乒乓測試 ===\n\n";
+    {
+        Channel<int> unbufferedPing, unbufferedPong;
+        Channel<int> bufferedPing(16), bufferedPong(16);
+        CondVarHandoff<int> handoffPing, handoffPong;
+        double unbufferedTime = testPingPongPerformance(unbufferedPing, unbufferedPong, roundTrips);
+        double bufferedTime = testPingPongPerformance(bufferedPing, bufferedPong, roundTrips);
+        double handoffTime = testPingPongPerformance(handoffPing, handoffPong, roundTrips);
+        std::cout << std::setw(widthLabel) << "Unbuffered channel / 無緩衝通道:" << std::setw(widthTime) << unbufferedTime / roundTrips * 1e6 << " us/round trip\n";
+        std::cout << std::setw(widthLabel) << "Buffered channel (16) / 有緩衝通道 (16):" << std::setw(widthTime) << bufferedTime / roundTrips * 1e6 << " us/round trip\n";
+        std::cout << std::setw(widthLabel) << "condition_variable hand-off / 條件變數交接:" << std::setw(widthTime) << handoffTime / roundTrips * 1e6 << " us/round trip\n";
+    }
+
+    int fanInItems = 100000;         // 每個生產者送出的值 / Values sent per producer
+    const int fanInProducers[] = { 2, 8 };
+    std::cout << "\n=== Channel Fan-in Tests / 通道匯流測試 ===\n\n";
+    for (int producersCount : fanInProducers)
+    {
+        double selectTime = testFanInPerformance(producersCount, fanInItems, 0);
+        double sharedChannelTime = testFanInPerformance(producersCount, fanInItems, 1);
+        double condvarTime = testFanInPerformance(producersCount, fanInItems, 2);
+        double totalItems = static_cast<double>(producersCount) * fanInItems;
+        std::string label = std::to_string(producersCount) + " producers -> 1 consumer / " + std::to_string(producersCount) + " 生產者 -> 1 消費者:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  select over per-producer channels / select 多通道:" << std::setw(widthTime) << totalItems / selectTime / 1e6 << " M items/sec\n";
+        std::cout << std::setw(widthLabel) << "  One shared channel / 共用單一通道:" << std::setw(widthTime) << totalItems / sharedChannelTime / 1e6 << " M items/sec\n";
+        std::cout << std::setw(widthLabel) << "  mutex + condition_variable queue / 條件變數佇列:" << std::setw(widthTime) << totalItems / condvarTime / 1e6 << " M items/sec\n\n";
+    }
+
+    return 0;   // 程式結束 / End program
+}
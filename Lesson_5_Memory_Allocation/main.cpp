@@ -0,0 +1,1620 @@
+//------------------------------------------------------------------------------
+// 標頭檔說明 / Include Libraries Explanation:
+//
+// <iostream>           : 提供輸入輸出串流功能，用於 std::cout、std::endl 等.
+//                         Provides input/output stream functionality.
+//
+// <thread>             : 提供多執行緒支持，例如 std::thread、std::this_thread 等.
+//                         Provides multi-threading support.
+//
+// <mutex>              : 提供互斥鎖功能，用於保護物件池登錄表與信箱.
+//                         Provides mutex functionality for the pool registry and mailboxes.
+//
+// <condition_variable> : 提供條件變數，用於 promise / future 的等待.
+//                         Provides condition variables for promise / future waits.
+//
+// <chrono>             : 提供計時與時間間隔功能，例如 high_resolution_clock.
+//                         Provides timing and duration functionalities.
+//
+// <vector>             : 提供動態陣列容器，用於儲存執行緒與物件批次.
+//                         Provides dynamic array container (std::vector).
+//
+// <atomic>             : 提供原子操作類別，用於無鎖倉庫堆疊與參考計數.
+//                         Provides atomics for the lock-free depot stacks and reference counts.
+//
+// <iomanip>            : 提供格式化輸出功能，例如 std::setw、std::setprecision.
+//                         Provides formatting manipulators.
+//
+// <unordered_set>      : 提供雜湊集合，用於記錄仍存在的物件池.
+//                         Provides hash sets for tracking live pools.
+//
+// <future>             : 提供 std::promise 與 std::future，作為對照組.
+//                         Provides std::promise and std::future as the baseline.
+//
+// <optional>           : 提供 std::optional，用於存放尚未設定的結果（C++17）.
+//                         Provides std::optional for results that are not set yet (C++17).
+//
+// <exception>          : 提供 std::exception_ptr，用於在執行緒之間傳遞例外.
+//                         Provides std::exception_ptr for passing exceptions between threads.
+//
+// <memory>             : 提供 std::unique_ptr，用於管理彈匣表.
+//                         Provides std::unique_ptr for owning the magazine table.
+//
+// <cstdint>            : 提供固定寬度整數型別，例如 std::uint64_t.
+//                         Provides fixed-width integer types such as std::uint64_t.
+//
+// <new>                : 提供 ::operator new / ::operator delete 與 placement new.
+//                         Provides raw operator new / delete and placement new.
+//
+// <string>             : 提供 std::string 與 std::to_string，用於組合輸出標籤.
+//                         Provides std::string and std::to_string for building output labels.
+//
+// <utility>            : 提供 std::move、std::forward、std::swap.
+//                         Provides std::move, std::forward and std::swap.
+//
+// <algorithm>          : 提供 std::find.
+//                         Provides std::find.
+//
+// <stdexcept>          : 提供 std::runtime_error，用於示範例外傳遞.
+//                         Provides std::runtime_error for the exception demo.
+//
+// <functional>         : 提供 std::function 與 std::bad_function_call，作為任務儲存的對照組.
+//                         Provides std::function (the task storage baseline) and std::bad_function_call.
+//
+// <cstddef>            : 提供 std::size_t 與 std::max_align_t.
+//                         Provides std::size_t and std::max_align_t.
+//
+// <random>             : 提供亂數產生器，用於產生混合大小的配置請求.
+//                         Provides random number generation for mixed-size requests.
+//
+// <list>               : 提供 std::list，作為使用自訂配置器的節點型容器.
+//                         Provides std::list as a node-based container using a custom allocator.
+//
+// <unordered_map>      : 提供 std::unordered_map，作為使用自訂配置器的雜湊表.
+//                         Provides std::unordered_map as a hash table using a custom allocator.
+//
+// <cstring>            : 提供 std::memcpy，用於搬移可平凡複製的閉包.
+//                         Provides std::memcpy for moving trivially copyable closures.
+//
+// <type_traits>        : 提供 std::decay、std::enable_if 等型別特性，用於 UniqueFunction.
+//                         Provides type traits (std::decay, std::enable_if) for UniqueFunction.
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <iomanip>
+#include <unordered_set>
+#include <future>
+#include <optional>
+#include <exception>
+#include <memory>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <cstddef>
+#include <random>
+#include <list>
+#include <unordered_map>
+#include <cstring>
+#include <type_traits>
+
+//===================================================================
+// 物件池登錄表 / Pool Registry
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 與 Lesson 3 的 DomainRegistry 相同的做法：每個執行緒在每個物件池中有一份快取，
+/// 第一次使用時建立並以物件池 id 記錄在 thread_local 清單中
+/// 執行緒結束時，若物件池仍存在就把快取歸還；物件池已解構則直接略過
+/// 物件池以遞增 id 識別，避免新物件池配置在舊位址時誤用過期的快取
+/// Per-thread, per-pool caches that are handed back when the thread exits.
+class PoolRegistry
+{
+public:
+    using ReleaseFunc = void (*)(void* pool, void* cache);
+
+    static unsigned long long registerPool()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        unsigned long long id = ++nextId();
+        livePools().insert(id);
+        return id;
+    }
+
+    static void unregisterPool(unsigned long long id)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        livePools().erase(id);
+    }
+
+    /// 取得目前執行緒在該物件池的快取；尚未建立時回傳 nullptr
+    static void* localCache(unsigned long long id)
+    {
+        for (const auto& entry : cache().entries)
+        {
+            if (entry.poolId == id)
+                return entry.cache;
+        }
+        return nullptr;
+    }
+
+    static void cacheLocal(unsigned long long id, void* pool, void* localCache, ReleaseFunc release)
+    {
+        cache().entries.push_back({ id, pool, localCache, release });
+    }
+
+private:
+    struct Entry
+    {
+        unsigned long long poolId;
+        void* pool;
+        void* cache;
+        ReleaseFunc release;
+    };
+
+    struct ThreadCaches
+    {
+        std::vector<Entry> entries;
+
+        ~ThreadCaches()
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            for (const auto& entry : entries)
+            {
+                if (livePools().count(entry.poolId))
+                    entry.release(entry.pool, entry.cache);     // 物件池仍存在：歸還快取
+            }
+        }
+    };
+
+    static std::mutex& mutex() { static std::mutex m; return m; }
+    static unsigned long long& nextId() { static unsigned long long id = 0; return id; }
+    static std::unordered_set<unsigned long long>& livePools() { static std::unordered_set<unsigned long long> s; return s; }
+    static ThreadCaches& cache() { thread_local ThreadCaches c; return c; }
+};
+
+//===================================================================
+// 執行緒快取物件池 / Thread-caching Object Pool
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 固定大小物件的執行緒快取物件池（Bonwick 的 magazine 設計）
+///   彈匣 (magazine)：最多存放 kMagazineSize 個空閒物件的陣列
+///   每個執行緒持有兩個彈匣 loaded / previous，大部分配置與釋放只操作自己的彈匣，不需要任何同步
+///   loaded 空了且 previous 也空了：把空彈匣交回倉庫，從倉庫換一個滿彈匣
+///   loaded 滿了且 previous 也滿了：把滿彈匣交給倉庫，從倉庫換一個空彈匣
+/// 倉庫 (depot)：滿彈匣與空彈匣各一個無鎖堆疊
+///   彈匣存放在固定的彈匣表中且永不釋放，堆疊以「彈匣索引 + 版本標籤」組成的 64 位元字做 CAS，
+///   每次修改都遞增標籤，因此不需要記憶體回收也不會發生 ABA
+/// 跨執行緒釋放：物件被哪個執行緒釋放，就進入該執行緒的彈匣，再經由倉庫流回配置端
+/// 物件大小在執行期指定，因此多個大小類別可以共用同一份程式碼（見 SizeClassAllocator）
+/// Thread-caching fixed-size block pool with per-thread magazines and a lock-free depot.
+class FixedSizePool
+{
+public:
+    static constexpr int kMagazineSize = 32;
+
+    /// objectSize  ：每個區塊的大小（位元組）
+    /// maxMagazines：彈匣表的大小，應至少為使用執行緒數的兩倍（每個執行緒固定持有兩個彈匣）；
+    ///               彈匣表用盡後才第一次使用的執行緒不會有快取，直接向系統配置與釋放（仍然正確，只是較慢）
+    explicit FixedSizePool(std::size_t objectSize, std::uint32_t maxMagazines = 4096)
+        : objectSize_(objectSize),
+          maxMagazines_(maxMagazines),
+          magazines_(new Magazine*[maxMagazines]),
+          id_(PoolRegistry::registerPool()) {}
+
+    /// 解構時所有使用此物件池的執行緒都不得再存取它；尚未歸還的物件由呼叫端負責
+    ~FixedSizePool()
+    {
+        PoolRegistry::unregisterPool(id_);
+        std::uint32_t count = magazineCount_.load();
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            Magazine* magazine = magazines_[i];
+            for (int k = 0; k < magazine->count; k++)
+                ::operator delete(magazine->items[k]);
+            delete magazine;
+        }
+        for (LocalCache* cache : caches_)
+            delete cache;
+    }
+
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+    /// 取得一塊 objectSize 的記憶體（未建構）
+    void* allocate()
+    {
+        LocalCache* cache = localCache();
+        if (!cache->loaded)
+            return ::operator new(objectSize_);                 // 沒有分到彈匣的執行緒
+        if (cache->loaded->count == 0)
+        {
+            if (cache->previous->count > 0)
+                std::swap(cache->loaded, cache->previous);
+            else if (Magazine* full = pop(fullHead_))
+            {
+                push(emptyHead_, cache->previous);
+                cache->previous = cache->loaded;
+                cache->loaded = full;
+            }
+            else
+                return ::operator new(objectSize_);             // 倉庫也沒有：向系統配置
+        }
+        return cache->loaded->items[--cache->loaded->count];
+    }
+
+    void deallocate(void* pointer)
+    {
+        LocalCache* cache = localCache();
+        if (!cache->loaded)
+        {
+            ::operator delete(pointer);                         // 沒有分到彈匣的執行緒
+            return;
+        }
+        if (cache->loaded->count == kMagazineSize)
+        {
+            if (cache->previous->count < kMagazineSize)
+                std::swap(cache->loaded, cache->previous);
+            else if (Magazine* empty = takeEmptyMagazine())
+            {
+                push(fullHead_, cache->previous);
+                cache->previous = cache->loaded;
+                cache->loaded = empty;
+            }
+            else
+            {
+                ::operator delete(pointer);                     // 彈匣用盡：還給系統
+                return;
+            }
+        }
+        cache->loaded->items[cache->loaded->count++] = pointer;
+    }
+
+private:
+    struct Magazine
+    {
+        void* items[kMagazineSize];
+        int count = 0;
+        std::atomic<std::uint32_t> next{ 0 };                   // 在倉庫堆疊中的下一個 (索引 + 1)，0 代表結尾
+        std::uint32_t index = 0;
+    };
+
+    struct LocalCache
+    {
+        Magazine* loaded;                                       // 兩者同時為 nullptr：彈匣表已滿，此執行緒不快取
+        Magazine* previous;
+    };
+
+    static constexpr unsigned long long kRecentSlots = 16;
+
+    struct RecentCache
+    {
+        unsigned long long id;
+        LocalCache* cache;
+    };
+
+    LocalCache* localCache()
+    {
+        // 每個執行緒以物件池 id 直接對應的小表記住最近的快取，避免每次都搜尋登錄表；
+        // id 不會重複使用，過期的項目只會比對失敗，不會被誤用
+        thread_local RecentCache recent[kRecentSlots] = {};
+        RecentCache& slot = recent[id_ % kRecentSlots];
+        if (slot.id == id_)
+            return slot.cache;
+
+        void* cached = PoolRegistry::localCache(id_);
+        if (cached)
+        {
+            slot = { id_, static_cast<LocalCache*>(cached) };
+            return slot.cache;
+        }
+
+        LocalCache* cache = new LocalCache{ takeEmptyMagazine(), takeEmptyMagazine() };
+        if (!cache->loaded || !cache->previous)
+        {
+            // 彈匣表已滿（執行緒數超過 maxMagazines / 2，或倉庫中堆積了許多滿彈匣）：
+            // 歸還已取得的那一個，此執行緒改為直接向系統配置，而不是使用 nullptr
+            for (Magazine* magazine : { cache->loaded, cache->previous })
+            {
+                if (magazine)
+                    push(emptyHead_, magazine);
+            }
+            cache->loaded = cache->previous = nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(growMutex_);
+            caches_.push_back(cache);
+        }
+        PoolRegistry::cacheLocal(id_, this, cache, &FixedSizePool::releaseCache);
+        slot = { id_, cache };
+        return cache;
+    }
+
+    /// 執行緒結束：把兩個彈匣都交回倉庫，其中的空閒物件可被其他執行緒使用
+    static void releaseCache(void* pool, void* localCache)
+    {
+        auto* self = static_cast<FixedSizePool*>(pool);
+        auto* cache = static_cast<LocalCache*>(localCache);
+        for (Magazine* magazine : { cache->loaded, cache->previous })
+        {
+            if (magazine)
+                self->push(magazine->count > 0 ? self->fullHead_ : self->emptyHead_, magazine);
+        }
+        std::lock_guard<std::mutex> lock(self->growMutex_);
+        self->caches_.erase(std::find(self->caches_.begin(), self->caches_.end(), cache));
+        delete cache;
+    }
+
+    /// 從倉庫取得空彈匣；沒有時建立新的彈匣，超過上限則回傳 nullptr
+    Magazine* takeEmptyMagazine()
+    {
+        if (Magazine* empty = pop(emptyHead_))
+            return empty;
+        std::lock_guard<std::mutex> lock(growMutex_);
+        std::uint32_t count = magazineCount_.load(std::memory_order_relaxed);
+        if (count == maxMagazines_)
+            return nullptr;
+        Magazine* magazine = new Magazine;
+        magazine->index = count;
+        magazines_[count] = magazine;
+        magazineCount_.store(count + 1, std::memory_order_release);
+        return magazine;
+    }
+
+    // 堆疊頂端的 64 位元字：高 32 位元為版本標籤，低 32 位元為 (彈匣索引 + 1)
+    void push(std::atomic<std::uint64_t>& head, Magazine* magazine)
+    {
+        std::uint64_t old = head.load(std::memory_order_relaxed);
+        std::uint64_t desired;
+        do
+        {
+            magazine->next.store(static_cast<std::uint32_t>(old), std::memory_order_relaxed);
+            desired = (((old >> 32) + 1) << 32) | (magazine->index + 1);
+        } while (!head.compare_exchange_weak(old, desired, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Magazine* pop(std::atomic<std::uint64_t>& head)
+    {
+        std::uint64_t old = head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::uint32_t top = static_cast<std::uint32_t>(old);
+            if (top == 0)
+                return nullptr;
+            Magazine* magazine = magazines_[top - 1];           // 彈匣永不釋放，讀取過期的 next 也安全
+            std::uint64_t desired = (((old >> 32) + 1) << 32) | magazine->next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old, desired, std::memory_order_acquire, std::memory_order_acquire))
+                return magazine;
+        }
+    }
+
+    const std::size_t objectSize_;
+    const std::uint32_t maxMagazines_;
+    std::unique_ptr<Magazine*[]> magazines_;
+    std::atomic<std::uint32_t> magazineCount_{ 0 };
+    alignas(64) std::atomic<std::uint64_t> fullHead_{ 0 };
+    alignas(64) std::atomic<std::uint64_t> emptyHead_{ 0 };
+    std::mutex growMutex_;                                      // 只在建立彈匣與執行緒快取時使用
+    std::vector<LocalCache*> caches_;
+    unsigned long long id_;
+};
+
+/// -----------------------------------------------------------------
+/// 以 sizeof(T) 建立的 FixedSizePool，另外提供建構 / 解構物件的 create / destroy
+/// Typed object pool over FixedSizePool.
+template<typename T>
+class ObjectPool : public FixedSizePool
+{
+public:
+    explicit ObjectPool(std::uint32_t maxMagazines = 4096)
+        : FixedSizePool(sizeof(T), maxMagazines) {}
+
+    template<typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate()) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object)
+    {
+        object->~T();
+        deallocate(object);
+    }
+};
+
+//===================================================================
+// 以物件池配置共享狀態的 promise / future / Pooled Promise and Future
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// promise 與 future 共用的狀態；由兩者以參考計數共同擁有，最後釋放的一方將它歸還物件池
+///   計數從 1 開始（只有 promise），get_future 成功時才加一，因此從未取出 future 也不會洩漏
+/// Shared state of PooledPromise / PooledFuture, recycled through an ObjectPool.
+template<typename T>
+struct PooledSharedState
+{
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::optional<T> value;
+    std::exception_ptr exception;
+    bool futureRetrieved = false;                               // 受 mutex 保護
+    std::atomic<int> references{ 1 };
+
+    static ObjectPool<PooledSharedState>& pool()
+    {
+        static ObjectPool<PooledSharedState> instance;
+        return instance;
+    }
+
+    void release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            pool().destroy(this);                               // 可能在另一個執行緒：跨執行緒釋放
+    }
+};
+
+template<typename T>
+class PooledFuture;
+
+/// -----------------------------------------------------------------
+/// 與 std::promise 相同用法，但共享狀態取自物件池而非每次 new
+/// A promise whose shared state comes from an ObjectPool instead of the heap.
+template<typename T>
+class PooledPromise
+{
+public:
+    PooledPromise() : state_(PooledSharedState<T>::pool().create()) {}
+    PooledPromise(PooledPromise&& other) noexcept : state_(other.state_) { other.state_ = nullptr; }
+    PooledPromise(const PooledPromise&) = delete;
+    PooledPromise& operator=(const PooledPromise&) = delete;
+    PooledPromise& operator=(PooledPromise&&) = delete;
+
+    /// 與 std::promise 相同：尚未設定結果就解構時，future 端會收到 broken_promise 例外而不是永遠等待
+    ~PooledPromise()
+    {
+        if (!state_)
+            return;
+        bool satisfied;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            satisfied = state_->value.has_value() || state_->exception;
+            if (!satisfied)
+                state_->exception = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+        }
+        if (!satisfied)
+            state_->ready.notify_all();
+        state_->release();
+    }
+
+    /// 只能呼叫一次，第二次呼叫與 std::promise 相同丟出 future_already_retrieved；
+    /// future 端會拿到同一個共享狀態
+    PooledFuture<T> get_future();
+
+    void set_value(T value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->value.emplace(std::move(value));
+        }
+        state_->ready.notify_all();
+    }
+
+    void set_exception(std::exception_ptr exception)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->exception = exception;
+        }
+        state_->ready.notify_all();
+    }
+
+private:
+    PooledSharedState<T>* state_;
+};
+
+/// -----------------------------------------------------------------
+/// 與 std::future 相同用法：get() 阻塞直到結果就緒，例外會重新拋出
+template<typename T>
+class PooledFuture
+{
+public:
+    explicit PooledFuture(PooledSharedState<T>* state) : state_(state) {}
+    PooledFuture(PooledFuture&& other) noexcept : state_(other.state_) { other.state_ = nullptr; }
+    PooledFuture(const PooledFuture&) = delete;
+    PooledFuture& operator=(const PooledFuture&) = delete;
+    PooledFuture& operator=(PooledFuture&&) = delete;
+
+    ~PooledFuture()
+    {
+        if (state_)
+            state_->release();
+    }
+
+    T get()
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->ready.wait(lock, [this] { return state_->value.has_value() || state_->exception; });
+        if (state_->exception)
+            std::rethrow_exception(state_->exception);
+        return std::move(*state_->value);
+    }
+
+private:
+    PooledSharedState<T>* state_;
+};
+
+template<typename T>
+PooledFuture<T> PooledPromise<T>::get_future()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->futureRetrieved)
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        state_->futureRetrieved = true;
+    }
+    state_->references.fetch_add(1, std::memory_order_relaxed);  // promise 仍持有一份參考，不會與釋放競爭
+    return PooledFuture<T>(state_);
+}
+
+//===================================================================
+// 執行緒本地競技場配置器 / Per-thread Arena Allocator
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 遞增指標 (bump pointer) 競技場配置器，只供單一執行緒使用
+///   allocate：把目前區塊的偏移量對齊後往前推，不夠時換到下一個區塊（必要時才向系統配置）
+///   reset   ：一次釋放所有配置，只把偏移量歸零；區塊保留下來重複使用，暖機後不再呼叫 malloc
+/// 不會呼叫解構子：存放需要解構的物件時，由使用者（例如 TaskBatch）負責
+/// Single-threaded bump allocator with bulk reset; blocks are kept for reuse.
+class Arena
+{
+public:
+    explicit Arena(std::size_t blockSize = 64 * 1024) : blockSize_(blockSize) {}
+
+    ~Arena()
+    {
+        for (const Block& block : blocks_)
+            ::operator delete(block.data);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        for (;;)
+        {
+            if (current_ < blocks_.size())
+            {
+                Block& block = blocks_[current_];
+                std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data);
+                std::size_t aligned = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+                if (aligned + size <= block.size)
+                {
+                    offset_ = aligned + size;
+                    return block.data + aligned;
+                }
+                ++current_;                                     // 目前區塊不夠，換下一個
+                offset_ = 0;
+                continue;
+            }
+            std::size_t blockBytes = std::max(blockSize_, size + alignment);
+            blocks_.push_back({ static_cast<char*>(::operator new(blockBytes)), blockBytes });
+        }
+    }
+
+    /// 批次結束：所有由此競技場配置的物件一次失效
+    void reset() noexcept
+    {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    std::size_t blockCount() const { return blocks_.size(); }
+
+private:
+    struct Block
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    const std::size_t blockSize_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+};
+
+/// -----------------------------------------------------------------
+/// 目前執行緒的競技場
+Arena& threadArena()
+{
+    thread_local Arena arena;
+    return arena;
+}
+
+/// -----------------------------------------------------------------
+/// 一批任務的閉包儲存：閉包放在提交執行緒的競技場中，而不是每個任務各自 new 一次
+///   add   ：在競技場中建構閉包，並記錄型別抹除後的呼叫 / 解構函式
+///   runAll：依序執行並解構所有閉包，最後 reset 競技場（批次邊界）
+/// 同一個競技場上同時只能有一個批次；批次的所有任務必須在 runAll 前完成提交
+/// 這是獨立的批次容器，並未接到執行緒池的佇列上；由呼叫端自行決定在哪個執行緒 runAll
+/// 任務丟出例外時，剩餘的閉包只解構不執行，競技場照樣 reset，例外再傳給呼叫端；
+/// 解構時尚未執行的任務直接丟棄（只解構），不會在解構子中執行任務
+/// Closure storage for a batch of tasks, carved from the submitting thread's arena.
+class TaskBatch
+{
+public:
+    explicit TaskBatch(Arena& arena) : arena_(arena) {}
+
+    ~TaskBatch() { discardFrom(0); }
+
+    TaskBatch(const TaskBatch&) = delete;
+    TaskBatch& operator=(const TaskBatch&) = delete;
+
+    template<typename Func>
+    void add(Func&& fn)
+    {
+        using Closure = typename std::decay<Func>::type;
+        void* storage = arena_.allocate(sizeof(Closure), alignof(Closure));
+        // 先登記再建構：push_back 丟出例外時閉包還不存在；建構丟出例外時撤銷登記
+        tasks_.push_back({ storage,
+                           [](void* p) { (*static_cast<Closure*>(p))(); },
+                           [](void* p) { static_cast<Closure*>(p)->~Closure(); } });
+        try
+        {
+            new (storage) Closure(std::forward<Func>(fn));
+        }
+        catch (...)
+        {
+            tasks_.pop_back();
+            throw;
+        }
+    }
+
+    /// 執行所有任務，回傳執行的數量
+    /// 任務丟出例外時，由 guard 解構剩餘（含丟出例外的那個）閉包並 reset 競技場
+    std::size_t runAll()
+    {
+        struct Guard
+        {
+            TaskBatch& batch;
+            std::size_t next = 0;
+            ~Guard() { batch.discardFrom(next); }
+        } guard{ *this };
+
+        std::size_t count = tasks_.size();
+        for (; guard.next < count; ++guard.next)
+        {
+            const Entry& task = tasks_[guard.next];
+            task.invoke(task.closure);
+            task.destroy(task.closure);
+        }
+        return count;
+    }
+
+private:
+    struct Entry
+    {
+        void* closure;
+        void (*invoke)(void*);
+        void (*destroy)(void*);
+    };
+
+    /// 解構索引 first 之後尚未執行的閉包（不執行），清空清單並 reset 競技場
+    void discardFrom(std::size_t first) noexcept
+    {
+        for (std::size_t i = first; i < tasks_.size(); ++i)
+            tasks_[i].destroy(tasks_[i].closure);
+        tasks_.clear();
+        arena_.reset();
+    }
+
+    Arena& arena_;
+    std::vector<Entry> tasks_;
+};
+
+//===================================================================
+// 小緩衝區最佳化的移動專用任務包裝 / Small-buffer-optimized Move-only Task Wrapper
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 只能移動、不能複製的 std::function 替代品
+///   閉包大小不超過 InlineSize、對齊不超過 max_align_t、且移動不會丟出例外時，直接存放在物件內部的緩衝區；
+///   否則才在堆積上配置，緩衝區只存指標
+///   每種閉包型別對應一份靜態操作表（呼叫 / 移動 / 解構），物件本身只多一個指標；
+///   可平凡複製的內部閉包（例如只捕捉 int 與指標）移動時直接複製緩衝區，解構時什麼都不做
+///   不需要複製，因此可以存放捕捉 std::unique_ptr、std::promise 等只能移動的閉包
+/// Move-only callable wrapper with a configurable inline buffer (default 48 bytes).
+template<typename Signature, std::size_t InlineSize = 48>
+class UniqueFunction;
+
+template<typename R, typename... Args, std::size_t InlineSize>
+class UniqueFunction<R(Args...), InlineSize>
+{
+public:
+    UniqueFunction() noexcept = default;
+
+    template<typename Func,
+             typename = typename std::enable_if<!std::is_same<typename std::decay<Func>::type, UniqueFunction>::value>::type>
+    UniqueFunction(Func&& fn)
+    {
+        using Closure = typename std::decay<Func>::type;
+        if constexpr (storedInline<Closure>())
+        {
+            new (buffer_) Closure(std::forward<Func>(fn));
+            ops_ = &InlineOps<Closure>::table;
+        }
+        else
+        {
+            *reinterpret_cast<Closure**>(buffer_) = new Closure(std::forward<Func>(fn));
+            ops_ = &HeapOps<Closure>::table;
+        }
+    }
+
+    UniqueFunction(UniqueFunction&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    ~UniqueFunction() { reset(); }
+
+    R operator()(Args... args)
+    {
+        if (ops_ == nullptr)
+            throw std::bad_function_call();
+        return ops_->invoke(buffer_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    /// 目前的閉包是否存放在內部緩衝區（測試用）
+    bool isInline() const noexcept { return ops_ != nullptr && ops_->isInline; }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* dst, void* src) noexcept;   // 移動到 dst 並解構 src；nullptr 表示直接複製緩衝區
+        void (*destroy)(void* storage) noexcept;        // nullptr 表示不需要解構
+        bool isInline;
+    };
+
+    template<typename Closure>
+    static constexpr bool storedInline()
+    {
+        return sizeof(Closure) <= InlineSize
+            && alignof(Closure) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<Closure>::value;
+    }
+
+    template<typename Closure>
+    struct InlineOps
+    {
+        static R invoke(void* storage, Args&&... args)
+        {
+            return (*static_cast<Closure*>(storage))(std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept
+        {
+            new (dst) Closure(std::move(*static_cast<Closure*>(src)));
+            static_cast<Closure*>(src)->~Closure();
+        }
+        static void destroy(void* storage) noexcept
+        {
+            static_cast<Closure*>(storage)->~Closure();
+        }
+        static constexpr bool kTrivial = std::is_trivially_copyable<Closure>::value
+                                      && std::is_trivially_destructible<Closure>::value;
+        static constexpr Ops table = { &invoke, kTrivial ? nullptr : &move, kTrivial ? nullptr : &destroy, true };
+    };
+
+    template<typename Closure>
+    struct HeapOps
+    {
+        static Closure* get(void* storage) { return *static_cast<Closure**>(storage); }
+        static R invoke(void* storage, Args&&... args)
+        {
+            return (*get(storage))(std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept
+        {
+            *static_cast<Closure**>(dst) = get(src);            // 只搬移指標
+        }
+        static void destroy(void* storage) noexcept
+        {
+            delete get(storage);
+        }
+        static constexpr Ops table = { &invoke, &move, &destroy, false };
+    };
+
+    void moveFrom(UniqueFunction& other) noexcept
+    {
+        if (other.ops_ != nullptr)
+        {
+            if (other.ops_->move != nullptr)
+                other.ops_->move(buffer_, other.buffer_);
+            else
+                std::memcpy(buffer_, other.buffer_, InlineSize);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    void reset() noexcept
+    {
+        if (ops_ != nullptr)
+        {
+            if (ops_->destroy != nullptr)
+                ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+    static_assert(InlineSize >= sizeof(void*), "InlineSize must hold at least a pointer");
+
+    alignas(std::max_align_t) unsigned char buffer_[InlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+//===================================================================
+// 大小類別執行緒快取配置器 / Size-class Thread-caching Allocator
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 以 FixedSizePool 為基礎的通用配置器（類似 tcmalloc 的大小類別設計）
+///   把請求大小向上取整到固定的大小類別，每個類別是一個 FixedSizePool，
+///   因此同樣有執行緒本地彈匣與無鎖倉庫，跨執行緒釋放也會經由倉庫流回
+///   大小類別以查表取得，各類別共用同一份程式碼，不需要依大小做間接呼叫
+///   超過 kMaxSmallSize 的請求直接交給 ::operator new / ::operator delete
+///   deallocate 需要傳入配置時的大小（與 std::allocator 相同的有大小釋放），因此區塊不需要標頭
+/// General-purpose allocator built from one FixedSizePool per size class.
+class SizeClassAllocator
+{
+public:
+    static constexpr std::size_t kMaxSmallSize = 1024;
+
+    SizeClassAllocator()
+    {
+        int c = 0;
+        for (std::size_t slot = 0; slot < kLookupSize; slot++)  // slot * 16 位元組對應的類別
+        {
+            while (kClassSizes[c] < slot * kGranularity)
+                c++;
+            classIndex_[slot] = static_cast<std::uint8_t>(c);
+        }
+        for (int i = 0; i < kClassCount; i++)
+            pools_[i].reset(new FixedSizePool(kClassSizes[i]));
+    }
+
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+
+    void* allocate(std::size_t size)
+    {
+        if (size > kMaxSmallSize)
+            return ::operator new(size);
+        return pools_[classOf(size)]->allocate();
+    }
+
+    void deallocate(void* pointer, std::size_t size)
+    {
+        if (size > kMaxSmallSize)
+        {
+            ::operator delete(pointer);
+            return;
+        }
+        pools_[classOf(size)]->deallocate(pointer);
+    }
+
+    /// 供 SizeClassStdAllocator 使用的全域實例
+    static SizeClassAllocator& global()
+    {
+        static SizeClassAllocator allocator;
+        return allocator;
+    }
+
+private:
+    // 皆為 16 的倍數，區塊因此維持 max_align_t 對齊；相鄰類別最多浪費約 1/3
+    static constexpr int kClassCount = 12;
+    static constexpr std::size_t kClassSizes[kClassCount] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+    static constexpr std::size_t kGranularity = 16;
+    static constexpr std::size_t kLookupSize = kMaxSmallSize / kGranularity + 1;
+
+    int classOf(std::size_t size) const
+    {
+        return classIndex_[(size + kGranularity - 1) / kGranularity];
+    }
+
+    std::unique_ptr<FixedSizePool> pools_[kClassCount];
+    std::uint8_t classIndex_[kLookupSize];
+};
+
+/// -----------------------------------------------------------------
+/// 標準配置器介面：讓 std::vector、std::list、std::unordered_map 等容器使用 SizeClassAllocator::global()
+/// 無狀態，所有實例都相等，因此容器之間可以自由移動與交換
+/// Standard allocator adapter over the global SizeClassAllocator.
+template<typename T>
+struct SizeClassStdAllocator
+{
+    using value_type = T;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    SizeClassStdAllocator() noexcept = default;
+
+    template<typename U>
+    SizeClassStdAllocator(const SizeClassStdAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        return static_cast<T*>(SizeClassAllocator::global().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t n) noexcept
+    {
+        SizeClassAllocator::global().deallocate(pointer, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const SizeClassStdAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    bool operator!=(const SizeClassStdAllocator<U>&) const noexcept { return false; }
+};
+
+//===================================================================
+// 效能測試 / Performance Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 測試用的固定大小物件，大小接近一個任務的共享狀態
+struct TaskRecord
+{
+    long long id = 0;
+    long long payload[7] = {};
+};
+
+/// -----------------------------------------------------------------
+/// 配置器包裝：以相同介面比較 new/delete 與 ObjectPool
+struct NewDeleteAllocator
+{
+    TaskRecord* create() { return new TaskRecord; }
+    void destroy(TaskRecord* record) { delete record; }
+};
+
+struct PoolAllocator
+{
+    ObjectPool<TaskRecord> pool;
+    TaskRecord* create() { return pool.create(); }
+    void destroy(TaskRecord* record) { pool.destroy(record); }
+};
+
+/// -----------------------------------------------------------------
+/// 測試配置 / 釋放吞吐量
+///   每個執行緒每輪配置 kBatch 個物件
+///   crossThread = false：由同一個執行緒釋放
+///   crossThread = true ：把整批交給下一個執行緒的信箱，並釋放別的執行緒交來的批次
+///                       （模擬任務在一個執行緒建立、在另一個執行緒完成）
+/// Allocate/free throughput with same-thread or cross-thread frees.
+template<typename AllocatorType>
+double testAllocatorPerformance(int numThreads, int rounds, bool crossThread)
+{
+    const int kBatch = 64;
+    AllocatorType allocator;
+    struct Mailbox
+    {
+        std::mutex mutex;
+        std::vector<std::vector<TaskRecord*>> batches;
+    };
+    std::vector<Mailbox> mailboxes(numThreads);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        Mailbox& inbox = mailboxes[threadId];
+        Mailbox& outbox = mailboxes[(threadId + 1) % numThreads];
+        std::vector<std::vector<TaskRecord*>> received;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int r = 0; r < rounds; r++)
+        {
+            std::vector<TaskRecord*> batch(kBatch);
+            for (int i = 0; i < kBatch; i++)
+            {
+                batch[i] = allocator.create();
+                batch[i]->id = i;
+            }
+            if (!crossThread)
+            {
+                for (TaskRecord* record : batch)
+                    allocator.destroy(record);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(outbox.mutex);
+                outbox.batches.push_back(std::move(batch));
+            }
+            {
+                std::lock_guard<std::mutex> lock(inbox.mutex);
+                received.swap(inbox.batches);
+            }
+            for (auto& other : received)
+            {
+                for (TaskRecord* record : other)
+                    allocator.destroy(record);
+            }
+            received.clear();
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    for (auto& mailbox : mailboxes)                             // 最後一輪交出但未被取走的批次
+    {
+        for (auto& batch : mailbox.batches)
+        {
+            for (TaskRecord* record : batch)
+                allocator.destroy(record);
+        }
+    }
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試 promise / future 交接
+///   客戶端執行緒每輪建立 kBatch 組 promise / future，把 promise 交給工作執行緒設定結果，
+///   再逐一 get()；共享狀態最後由哪一端釋放取決於執行順序，因此包含跨執行緒釋放
+/// Promise/future round trips; PromiseType is std::promise<int> or PooledPromise<int>.
+template<typename PromiseType>
+double testPromisePerformance(int rounds)
+{
+    const int kBatch = 64;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<PromiseType> pending;
+    bool done = false;
+
+    std::thread worker([&]()
+    {
+        std::vector<PromiseType> local;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !pending.empty() || done; });
+                if (pending.empty() && done)
+                    return;
+                local.swap(pending);
+            }
+            for (auto& promise : local)
+                promise.set_value(1);
+            local.clear();
+        }
+    });
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    long long total = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        std::vector<PromiseType> promises(kBatch);
+        std::vector<decltype(promises[0].get_future())> futures;
+        futures.reserve(kBatch);
+        for (auto& promise : promises)
+            futures.push_back(promise.get_future());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& promise : promises)
+                pending.push_back(std::move(promise));
+        }
+        cv.notify_one();
+        for (auto& future : futures)
+            total += future.get();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    worker.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (total != static_cast<long long>(rounds) * kBatch)
+        std::cout << "[testPromisePerformance] Lost results!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 大量微小任務的提交測試
+///   每個執行緒提交 tasksPerThread 個任務，每 kBatch 個為一批，批次結束時執行並清空
+///   閉包捕捉 4 個 int 與一個指標（24 位元組以上），超過 std::function 的內建緩衝區，
+///   因此 std::function 版本每個任務都要向堆積配置一次
+///   useArena = true ：閉包存放在 TaskBatch / 執行緒競技場
+///   useArena = false：閉包存放在 std::vector<std::function<void()>>
+/// Many threads submitting tiny tasks; compares heap-allocated std::function with arena storage.
+double testTaskSubmissionPerformance(int numThreads, int tasksPerThread, bool useArena)
+{
+    const int kBatch = 256;
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<long long> checksum(0);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        long long localSum = 0;
+        long long* sink = &localSum;
+        std::vector<std::function<void()>> functions;
+        functions.reserve(kBatch);
+        TaskBatch batch(threadArena());
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int i = 0; i < tasksPerThread; i++)
+        {
+            int id = threadId, value = i, a = 1, b = 2;
+            auto task = [id, value, a, b, sink]() { *sink += id + value + a + b; };
+            if (useArena)
+            {
+                batch.add(task);
+                if ((i + 1) % kBatch == 0)
+                    batch.runAll();
+            }
+            else
+            {
+                functions.emplace_back(task);
+                if ((i + 1) % kBatch == 0)
+                {
+                    for (auto& fn : functions)
+                        fn();
+                    functions.clear();
+                }
+            }
+        }
+        batch.runAll();
+        for (auto& fn : functions)
+            fn();
+        checksum.fetch_add(localSum);
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    long long expected = 0;
+    for (long long t = 0; t < numThreads; t++)
+        expected += t * tasksPerThread + static_cast<long long>(tasksPerThread) * (tasksPerThread - 1) / 2 + 3LL * tasksPerThread;
+    if (checksum.load() != expected)
+        std::cout << "[testTaskSubmissionPerformance] Lost tasks!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 可變大小配置器包裝：以相同介面比較系統配置器與 SizeClassAllocator
+struct SystemAllocator
+{
+    void* allocate(std::size_t size) { return ::operator new(size); }
+    void deallocate(void* pointer, std::size_t) { ::operator delete(pointer); }
+};
+
+/// -----------------------------------------------------------------
+/// 多執行緒混合大小配置測試（與 Lesson 2 相同的 readyCount / startFlag 架構）
+///   每個執行緒每輪配置 kBatch 塊混合大小的記憶體並寫入第一個位元組：
+///   約 60% 為 8~128 位元組、30% 為 129~1024 位元組、10% 為 1025~4096 位元組（超過大小類別，兩者都走系統配置器）
+///   crossThread = false：由同一個執行緒釋放
+///   crossThread = true ：把整批交給下一個執行緒的信箱，並釋放別的執行緒交來的批次
+/// Mixed-size allocate/free throughput with same-thread or cross-thread frees.
+template<typename AllocatorType>
+double testMixedAllocationPerformance(int numThreads, int rounds, bool crossThread)
+{
+    const int kBatch = 64;
+    const int kSizeCount = 4096;
+    AllocatorType allocator;
+    struct Allocation
+    {
+        void* pointer;
+        std::size_t size;
+    };
+    struct Mailbox
+    {
+        std::mutex mutex;
+        std::vector<std::vector<Allocation>> batches;
+    };
+    std::vector<Mailbox> mailboxes(numThreads);
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        std::minstd_rand rng(threadId + 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::vector<std::size_t> sizes(kSizeCount);             // 先產生大小，計時範圍內不含亂數成本
+        for (auto& size : sizes)
+        {
+            int p = percent(rng);
+            if (p < 60)
+                size = std::uniform_int_distribution<std::size_t>(8, 128)(rng);
+            else if (p < 90)
+                size = std::uniform_int_distribution<std::size_t>(129, 1024)(rng);
+            else
+                size = std::uniform_int_distribution<std::size_t>(1025, 4096)(rng);
+        }
+        Mailbox& inbox = mailboxes[threadId];
+        Mailbox& outbox = mailboxes[(threadId + 1) % numThreads];
+        std::vector<std::vector<Allocation>> received;
+        int next = 0;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int r = 0; r < rounds; r++)
+        {
+            std::vector<Allocation> batch(kBatch);
+            for (auto& allocation : batch)
+            {
+                allocation.size = sizes[next];
+                next = (next + 1) % kSizeCount;
+                allocation.pointer = allocator.allocate(allocation.size);
+                *static_cast<char*>(allocation.pointer) = static_cast<char>(r);
+            }
+            if (!crossThread)
+            {
+                for (const auto& allocation : batch)
+                    allocator.deallocate(allocation.pointer, allocation.size);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(outbox.mutex);
+                outbox.batches.push_back(std::move(batch));
+            }
+            {
+                std::lock_guard<std::mutex> lock(inbox.mutex);
+                received.swap(inbox.batches);
+            }
+            for (auto& other : received)
+            {
+                for (const auto& allocation : other)
+                    allocator.deallocate(allocation.pointer, allocation.size);
+            }
+            received.clear();
+        }
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    for (auto& mailbox : mailboxes)                             // 最後一輪交出但未被取走的批次
+    {
+        for (auto& batch : mailbox.batches)
+        {
+            for (const auto& allocation : batch)
+                allocator.deallocate(allocation.pointer, allocation.size);
+        }
+    }
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試以配置器參數化的標準容器
+///   每個執行緒每輪在自己的 std::unordered_map 與 std::list 插入 kEntries 個元素後清空，
+///   節點型容器每個元素都要配置一次，是最依賴配置器的情況
+///   AllocatorTemplate：std::allocator 或 SizeClassStdAllocator
+/// Node-based containers plugged with the given allocator template.
+template<template<typename> class AllocatorTemplate>
+double testContainerAllocatorPerformance(int numThreads, int rounds)
+{
+    const int kEntries = 256;
+    using MapType = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                       AllocatorTemplate<std::pair<const int, int>>>;
+    using ListType = std::list<int, AllocatorTemplate<int>>;
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> startFlag(false);
+    std::atomic<long long> checksum(0);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    auto threadFunc = [&](int threadId)
+    {
+        long long localSum = 0;
+        readyCount.fetch_add(1);
+        while (!startFlag)
+            { std::this_thread::yield(); }
+        for (int r = 0; r < rounds; r++)
+        {
+            MapType map;
+            ListType list;
+            for (int i = 0; i < kEntries; i++)
+            {
+                map.emplace(i, threadId);
+                list.push_back(i);
+            }
+            localSum += static_cast<long long>(map.size() + list.size());
+        }
+        checksum.fetch_add(localSum);
+    };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(threadFunc, i);
+
+    while (readyCount.load() < numThreads)
+        { std::this_thread::yield(); }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    startFlag = true;
+    for (auto &th : threads)
+         th.join();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (checksum.load() != 2LL * kEntries * rounds * numThreads)
+        std::cout << "[testContainerAllocatorPerformance] Lost entries!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 任務包裝的各階段時間（秒）
+struct TaskWrapperResult
+{
+    double constructSec = 0.0;  // 由閉包建構包裝物件
+    double moveSec = 0.0;       // 移動到另一個容器並解構原物件（模擬放入佇列再取出）
+    double invokeSec = 0.0;     // 呼叫並解構
+};
+
+/// -----------------------------------------------------------------
+/// 測試任務包裝的建構 / 移動 / 呼叫成本（單執行緒，排除同步的影響）
+///   每輪建構 kBatch 個包裝放入 queued，移動到 taken（模擬放入佇列再由工作執行緒取出），再呼叫並解構；
+///   兩個容器重複使用，量到的是包裝本身的成本，而不是第一次碰觸記憶體的分頁錯誤
+///   閉包與 Lesson 1 的 basicTask(id, iterations) 相同大小：兩個 int 加上一個結果指標（16 位元組）
+///   largeCapture = true 時再捕捉 4 個 long long（48 位元組），超過 std::function 的內建緩衝區
+///   WrapperType：std::function<void()>、std::packaged_task<void()> 或 UniqueFunction<void()>
+/// Construction, move and invocation cost of a task wrapper for basicTask-sized closures.
+template<typename WrapperType>
+TaskWrapperResult testTaskWrapperPerformance(int numTasks, bool largeCapture)
+{
+    const int kBatch = 1024;
+    using Clock = std::chrono::high_resolution_clock;
+    TaskWrapperResult result;
+    long long sum = 0;
+    long long* sink = &sum;
+    std::vector<WrapperType> queued;
+    std::vector<WrapperType> taken;
+    queued.reserve(kBatch);
+    taken.reserve(kBatch);
+
+    for (int base = 0; base < numTasks; base += kBatch)
+    {
+        int count = std::min(kBatch, numTasks - base);
+        auto startTime = Clock::now();
+        for (int i = base; i < base + count; i++)
+        {
+            int id = i, iterations = 3;
+            if (largeCapture)
+            {
+                long long weights[4] = { 1, 2, 3, 4 };
+                queued.emplace_back([id, iterations, sink, weights]() { *sink += id + iterations + weights[3]; });
+            }
+            else
+            {
+                queued.emplace_back([id, iterations, sink]() { *sink += id + iterations; });
+            }
+        }
+        auto constructedTime = Clock::now();
+        for (auto& task : queued)
+            taken.push_back(std::move(task));
+        queued.clear();
+        auto movedTime = Clock::now();
+        for (auto& task : taken)
+            task();
+        taken.clear();
+        auto endTime = Clock::now();
+        result.constructSec += std::chrono::duration<double>(constructedTime - startTime).count();
+        result.moveSec += std::chrono::duration<double>(movedTime - constructedTime).count();
+        result.invokeSec += std::chrono::duration<double>(endTime - movedTime).count();
+    }
+
+    long long expected = static_cast<long long>(numTasks) * (numTasks - 1) / 2 + (largeCapture ? 7LL : 3LL) * numTasks;
+    if (sum != expected)
+        std::cout << "[testTaskWrapperPerformance] Lost tasks!" << std::endl;
+    return result;
+}
+
+int main()
+{
+    // 輸出格式設定 / Output formatting settings
+    const int widthLabel = 50;
+    const int widthTime  = 12;
+    std::cout << std::fixed << std::setprecision(6);
+
+    // ------ 例外經由物件池 promise 傳遞 / Exceptions through a Pooled Promise ------
+    std::cout << "\n=== Pooled Promise and Future / 物件池 promise 與 future ===\n\n";
+    {
+        PooledPromise<int> prom;
+        PooledFuture<int> fut = prom.get_future();
+        std::thread t([&prom]()
+        {
+            try
+            {
+                throw std::runtime_error("Exception from pooled task");
+            }
+            catch (...)
+            {
+                prom.set_exception(std::current_exception());
+            }
+        });
+        try
+        {
+            fut.get();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "[Main] Caught exception: " << e.what() << std::endl;
+        }
+        t.join();
+    }
+
+    // ------ 物件池配置測試 / Object Pool Allocation Tests ------
+    int allocRounds = 20000;        // 每個執行緒的輪數（每輪 64 個物件）/ Rounds per thread (64 objects each)
+    const int threadCounts[] = { 1, 2, 4, 8 };
+
+    std::cout << "\n=== Object Pool Allocation Tests / 物件池配置測試 ===\n\n";
+    for (int numThreads : threadCounts)
+    {
+        double newSame = testAllocatorPerformance<NewDeleteAllocator>(numThreads, allocRounds, false);
+        double poolSame = testAllocatorPerformance<PoolAllocator>(numThreads, allocRounds, false);
+        double newCross = testAllocatorPerformance<NewDeleteAllocator>(numThreads, allocRounds, true);
+        double poolCross = testAllocatorPerformance<PoolAllocator>(numThreads, allocRounds, true);
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  new/delete, same-thread free / 同執行緒釋放:" << std::setw(widthTime) << newSame << " sec\n";
+        std::cout << std::setw(widthLabel) << "  ObjectPool, same-thread free / 同執行緒釋放:" << std::setw(widthTime) << poolSame << " sec\n";
+        std::cout << std::setw(widthLabel) << "  new/delete, cross-thread free / 跨執行緒釋放:" << std::setw(widthTime) << newCross << " sec\n";
+        std::cout << std::setw(widthLabel) << "  ObjectPool, cross-thread free / 跨執行緒釋放:" << std::setw(widthTime) << poolCross << " sec\n\n";
+    }
+
+    // ------ promise / future 交接測試 / Promise and Future Hand-off Tests ------
+    int promiseRounds = 20000;      // 每輪 64 組 promise / future / Rounds of 64 promise/future pairs
+    std::cout << "\n=== Promise/Future Hand-off Tests / promise 與 future 交接測試 ===\n\n";
+    double stdPromiseTime = testPromisePerformance<std::promise<int>>(promiseRounds);
+    double pooledPromiseTime = testPromisePerformance<PooledPromise<int>>(promiseRounds);
+    std::cout << std::setw(widthLabel) << "std::promise / std::future:" << std::setw(widthTime) << stdPromiseTime << " sec\n";
+    std::cout << std::setw(widthLabel) << "PooledPromise / PooledFuture:" << std::setw(widthTime) << pooledPromiseTime << " sec\n";
+
+    // ------ 微小任務提交測試 / Tiny Task Submission Tests ------
+    int totalTasks = 3200000;       // 所有執行緒合計提交的任務數 / Tasks submitted by all threads
+    const int submitThreads[] = { 1, 8, 64 };
+    std::cout << "\n=== Tiny Task Submission Tests / 微小任務提交測試 ===\n\n";
+    for (int numThreads : submitThreads)
+    {
+        int tasksPerThread = totalTasks / numThreads;
+        double functionTime = testTaskSubmissionPerformance(numThreads, tasksPerThread, false);
+        double arenaTime = testTaskSubmissionPerformance(numThreads, tasksPerThread, true);
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  std::function (heap) / std::function（堆積）:" << std::setw(widthTime) << functionTime << " sec"
+                  << std::setw(widthTime) << functionTime / totalTasks * 1e9 << " ns/task\n";
+        std::cout << std::setw(widthLabel) << "  TaskBatch + thread arena / 執行緒競技場:" << std::setw(widthTime) << arenaTime << " sec"
+                  << std::setw(widthTime) << arenaTime / totalTasks * 1e9 << " ns/task\n\n";
+    }
+
+    // ------ 移動專用任務包裝 / Move-only Task Wrapper ------
+    std::cout << "\n=== Move-only Task Wrapper / 移動專用任務包裝 ===\n\n";
+    {
+        // std::function 要求可複製，無法存放捕捉 std::unique_ptr 的閉包
+        auto owned = std::make_unique<int>(42);
+        UniqueFunction<int()> task([value = std::move(owned)]() { return *value; });
+        UniqueFunction<int()> queuedTask = std::move(task);
+        std::cout << "[Main] Move-only closure returned " << queuedTask()
+                  << (queuedTask.isInline() ? " (inline / 內部緩衝區)" : " (heap / 堆積)") << std::endl;
+    }
+
+    // ------ 任務包裝成本測試 / Task Wrapper Cost Tests ------
+    int wrapperTasks = 1000000;     // 每種包裝建構、移動、呼叫的任務數 / Tasks per wrapper
+    std::cout << "\n=== Task Wrapper Cost Tests / 任務包裝成本測試 ===\n\n";
+    for (bool largeCapture : { false, true })
+    {
+        TaskWrapperResult results[3] = {
+            testTaskWrapperPerformance<std::function<void()>>(wrapperTasks, largeCapture),
+            testTaskWrapperPerformance<std::packaged_task<void()>>(wrapperTasks, largeCapture),
+            testTaskWrapperPerformance<UniqueFunction<void()>>(wrapperTasks, largeCapture)
+        };
+        const char* names[3] = { "  std::function", "  std::packaged_task", "  UniqueFunction<48>" };
+        std::cout << (largeCapture ? "48-byte capture / 48 位元組捕捉" : "16-byte capture (basicTask) / 16 位元組捕捉")
+                  << " (construct / move / invoke, ns per task):\n";
+        for (int w = 0; w < 3; w++)
+        {
+            std::cout << std::setw(widthLabel) << (std::string(names[w]) + ":")
+                      << std::setw(widthTime) << results[w].constructSec / wrapperTasks * 1e9
+                      << std::setw(widthTime) << results[w].moveSec / wrapperTasks * 1e9
+                      << std::setw(widthTime) << results[w].invokeSec / wrapperTasks * 1e9 << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    // ------ 混合大小配置競爭測試 / Mixed-size Allocation Contention Tests ------
+    int mixedRounds = 20000;        // 每個執行緒的輪數（每輪 64 塊混合大小）/ Rounds per thread (64 mixed-size blocks each)
+    std::cout << "\n=== Mixed-size Allocation Contention Tests / 混合大小配置競爭測試 ===\n\n";
+    for (int numThreads : threadCounts)
+    {
+        double systemSame = testMixedAllocationPerformance<SystemAllocator>(numThreads, mixedRounds, false);
+        double classSame = testMixedAllocationPerformance<SizeClassAllocator>(numThreads, mixedRounds, false);
+        double systemCross = testMixedAllocationPerformance<SystemAllocator>(numThreads, mixedRounds, true);
+        double classCross = testMixedAllocationPerformance<SizeClassAllocator>(numThreads, mixedRounds, true);
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  system, same-thread free / 同執行緒釋放:" << std::setw(widthTime) << systemSame << " sec\n";
+        std::cout << std::setw(widthLabel) << "  size-class, same-thread free / 同執行緒釋放:" << std::setw(widthTime) << classSame << " sec\n";
+        std::cout << std::setw(widthLabel) << "  system, cross-thread free / 跨執行緒釋放:" << std::setw(widthTime) << systemCross << " sec\n";
+        std::cout << std::setw(widthLabel) << "  size-class, cross-thread free / 跨執行緒釋放:" << std::setw(widthTime) << classCross << " sec\n\n";
+    }
+
+    // ------ 容器配置器測試 / Container Allocator Tests ------
+    int containerRounds = 2000;     // 每個執行緒的輪數（每輪 256 個元素）/ Rounds per thread (256 entries each)
+    std::cout << "\n=== Container Allocator Tests / 容器配置器測試 ===\n\n";
+    for (int numThreads : threadCounts)
+    {
+        double stdTime = testContainerAllocatorPerformance<std::allocator>(numThreads, containerRounds);
+        double classTime = testContainerAllocatorPerformance<SizeClassStdAllocator>(numThreads, containerRounds);
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  std::allocator:" << std::setw(widthTime) << stdTime << " sec\n";
+        std::cout << std::setw(widthLabel) << "  SizeClassStdAllocator:" << std::setw(widthTime) << classTime << " sec\n\n";
+    }
+
+    return 0;   // 程式結束 / End program
+}
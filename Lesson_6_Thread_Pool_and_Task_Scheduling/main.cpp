@@ -0,0 +1,1983 @@
+//------------------------------------------------------------------------------
+// 標頭檔說明 / Include Libraries Explanation:
+//
+// <iostream>           : 提供輸入輸出串流功能，用於 std::cout、std::endl 等.
+//                         Provides input/output stream functionality.
+//
+// <thread>             : 提供多執行緒支持，例如 std::thread、std::jthread、std::this_thread 等.
+//                         Provides multi-threading support, including std::jthread.
+//
+// <mutex>              : 提供互斥鎖功能，用於保護任務佇列.
+//                         Provides mutex functionality for the task queues.
+//
+// <condition_variable> : 提供條件變數，讓閒置的工作執行緒睡眠；condition_variable_any 用於可取消的睡眠.
+//                         Provides condition variables for idle workers and interruptible sleeps.
+//
+// <chrono>             : 提供計時與時間間隔功能，例如 high_resolution_clock.
+//                         Provides timing and duration functionalities.
+//
+// <vector>             : 提供動態陣列容器，用於儲存執行緒與資料向量.
+//                         Provides dynamic array container (std::vector).
+//
+// <deque>              : 提供雙端佇列，作為每個工作執行緒的任務佇列.
+//                         Provides double-ended queues used as per-worker task queues.
+//
+// <array>              : 提供固定大小陣列，存放依優先權分開的全域佇列.
+//                         Provides std::array holding the per-priority global queues.
+//
+// <map>                : 提供有序映射，作為依時間排序的期限表.
+//                         Provides std::map, used as the time-ordered table of deadlines.
+//
+// <atomic>             : 提供原子操作類別，以及 C++20 的 wait / notify.
+//                         Provides atomics, including C++20 wait / notify.
+//
+// <iomanip>            : 提供格式化輸出功能，例如 std::setw、std::setprecision.
+//                         Provides formatting manipulators.
+//
+// <future>             : 提供 std::promise 與 std::future，用於取得任務結果.
+//                         Provides std::promise and std::future for task results.
+//
+// <exception>          : 提供 std::exception_ptr，用於在執行緒之間傳遞例外.
+//                         Provides std::exception_ptr for passing exceptions between threads.
+//
+// <memory>             : 提供 std::unique_ptr，用於管理工作執行緒的狀態.
+//                         Provides std::unique_ptr for owning per-worker state.
+//
+// <functional>         : 提供 std::bad_function_call.
+//                         Provides std::bad_function_call.
+//
+// <string>             : 提供 std::string 與 std::to_string，用於組合輸出標籤.
+//                         Provides std::string and std::to_string for building output labels.
+//
+// <utility>            : 提供 std::move、std::forward.
+//                         Provides std::move and std::forward.
+//
+// <type_traits>        : 提供 std::decay_t、std::invoke_result_t 等型別特性.
+//                         Provides type traits such as std::decay_t and std::invoke_result_t.
+//
+// <cstddef>            : 提供 std::size_t 與 std::max_align_t.
+//                         Provides std::size_t and std::max_align_t.
+//
+// <cstdint>            : 提供 std::uint64_t，用於區分相同時間的期限.
+//                         Provides std::uint64_t to tell apart deadlines at the same time point.
+//
+// <cstring>            : 提供 std::memcpy，用於搬移可平凡複製的閉包.
+//                         Provides std::memcpy for moving trivially copyable closures.
+//
+// <algorithm>          : 提供 std::max、std::min.
+//                         Provides std::max and std::min.
+//
+// <stdexcept>          : 提供 std::runtime_error，用於示範例外傳遞與 TaskScopeError.
+//                         Provides std::runtime_error for the exception demo and TaskScopeError.
+//
+// <stop_token>         : 提供 std::stop_source、std::stop_token（C++20），用於協作式取消.
+//                         Provides std::stop_source and std::stop_token (C++20) for cooperative cancellation.
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <array>
+#include <map>
+#include <atomic>
+#include <iomanip>
+#include <future>
+#include <exception>
+#include <memory>
+#include <functional>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <stop_token>
+
+//===================================================================
+// 移動專用任務包裝 / Move-only Task Wrapper
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 與 Lesson 5 的 UniqueFunction 相同：只能移動，閉包不超過 InlineSize 時存放在物件內部
+/// 任務佇列存放的是 UniqueFunction<void()>，因此可以放入捕捉 std::promise 的閉包，
+/// 且一般大小的任務不需要另外配置記憶體
+/// Move-only callable wrapper with an inline buffer (see Lesson 5).
+template<typename Signature, std::size_t InlineSize = 48>
+class UniqueFunction;
+
+template<typename R, typename... Args, std::size_t InlineSize>
+class UniqueFunction<R(Args...), InlineSize>
+{
+public:
+    UniqueFunction() noexcept = default;
+
+    template<typename Func,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, UniqueFunction>>>
+    UniqueFunction(Func&& fn)
+    {
+        using Closure = std::decay_t<Func>;
+        if constexpr (storedInline<Closure>())
+        {
+            new (buffer_) Closure(std::forward<Func>(fn));
+            ops_ = &InlineOps<Closure>::table;
+        }
+        else
+        {
+            *reinterpret_cast<Closure**>(buffer_) = new Closure(std::forward<Func>(fn));
+            ops_ = &HeapOps<Closure>::table;
+        }
+    }
+
+    UniqueFunction(UniqueFunction&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    ~UniqueFunction() { reset(); }
+
+    R operator()(Args... args)
+    {
+        if (ops_ == nullptr)
+            throw std::bad_function_call();
+        return ops_->invoke(buffer_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* dst, void* src) noexcept;   // nullptr 表示直接複製緩衝區
+        void (*destroy)(void* storage) noexcept;        // nullptr 表示不需要解構
+    };
+
+    template<typename Closure>
+    static constexpr bool storedInline()
+    {
+        return sizeof(Closure) <= InlineSize
+            && alignof(Closure) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Closure>;
+    }
+
+    template<typename Closure>
+    struct InlineOps
+    {
+        static R invoke(void* storage, Args&&... args)
+        {
+            return (*static_cast<Closure*>(storage))(std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept
+        {
+            new (dst) Closure(std::move(*static_cast<Closure*>(src)));
+            static_cast<Closure*>(src)->~Closure();
+        }
+        static void destroy(void* storage) noexcept
+        {
+            static_cast<Closure*>(storage)->~Closure();
+        }
+        static constexpr bool kTrivial = std::is_trivially_copyable_v<Closure>
+                                      && std::is_trivially_destructible_v<Closure>;
+        static constexpr Ops table = { &invoke, kTrivial ? nullptr : &move, kTrivial ? nullptr : &destroy };
+    };
+
+    template<typename Closure>
+    struct HeapOps
+    {
+        static Closure* get(void* storage) { return *static_cast<Closure**>(storage); }
+        static R invoke(void* storage, Args&&... args)
+        {
+            return (*get(storage))(std::forward<Args>(args)...);
+        }
+        static void move(void* dst, void* src) noexcept
+        {
+            *static_cast<Closure**>(dst) = get(src);
+        }
+        static void destroy(void* storage) noexcept
+        {
+            delete get(storage);
+        }
+        static constexpr Ops table = { &invoke, &move, &destroy };
+    };
+
+    void moveFrom(UniqueFunction& other) noexcept
+    {
+        if (other.ops_ != nullptr)
+        {
+            if (other.ops_->move != nullptr)
+                other.ops_->move(buffer_, other.buffer_);
+            else
+                std::memcpy(buffer_, other.buffer_, InlineSize);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    void reset() noexcept
+    {
+        if (ops_ != nullptr)
+        {
+            if (ops_->destroy != nullptr)
+                ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer_[InlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+using Task = UniqueFunction<void()>;
+
+//===================================================================
+// 執行緒池 / Thread Pool
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 任務優先權：數值越小越優先 / Task priority, lower value runs first
+enum class TaskPriority
+{
+    High,
+    Normal,
+    Low
+};
+
+constexpr int kNumPriorities = 3;
+
+/// -----------------------------------------------------------------
+/// 可重複使用的工作竊取 (work-stealing) 執行緒池
+///   每個工作執行緒有自己的任務佇列：工作執行緒內提交的任務放入自己的佇列尾端，並從尾端取出（LIFO，資料仍在快取中）
+///   外部執行緒提交的任務放入全域佇列
+///   自己的佇列空了：先取全域佇列，再從其他工作執行緒的佇列前端竊取（FIFO，通常是較大的工作）
+///   閒置的工作執行緒在條件變數上睡眠；queued_ 記錄尚未被取走的任務數，
+///   提交端先遞增 queued_ 再讀取 sleepers_，睡眠端先遞增 sleepers_ 再檢查 queued_（皆為 seq_cst），
+///   因此兩者至少有一方看到另一方，只有在確實有人睡眠時才需要取得鎖來喚醒
+/// 優先權：外部執行緒提交或指定了 TaskPriority 的任務放入依優先權分開的全域佇列，取出時先取最高優先權；
+///   為了避免低優先權任務餓死，任務每等待 agingInterval，就相當於比之後才提交的任務高一級（aging）
+///   只決定下一個被取出的任務，不會中斷執行中的任務；工作執行緒自己佇列中的任務（巢狀分割的工作）仍最先執行
+/// 解構時會先執行完所有已提交的任務，再結束工作執行緒
+/// 經由 submit 提交的任務不得丟出例外（與 std::thread 相同，例外離開工作執行緒會呼叫 std::terminate）；
+/// 需要結果或例外時使用 async 或 TaskGroup
+/// Reusable work-stealing thread pool with per-worker deques and per-priority global queues with aging.
+class ThreadPool
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// numThreads 至少為 1：future::get() 不會幫忙執行任務，沒有工作執行緒時 async 的結果永遠不會完成
+    explicit ThreadPool(unsigned numThreads = std::max(1u, std::thread::hardware_concurrency()),
+                        Clock::duration agingInterval = std::chrono::milliseconds(50))
+        : agingInterval_(agingInterval)
+    {
+        numThreads = std::max(1u, numThreads);
+        for (unsigned i = 0; i < numThreads; i++)
+            workers_.push_back(std::make_unique<Worker>());
+        threads_.reserve(numThreads);
+        for (unsigned i = 0; i < numThreads; i++)
+            threads_.emplace_back(&ThreadPool::workerLoop, this, static_cast<int>(i));
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        sleepCv_.notify_all();
+        for (auto &th : threads_)
+             th.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    /// 提交不需要結果的任務；工作執行緒內提交的放入自己的佇列，外部提交的以 Normal 優先權放入全域佇列
+    void submit(Task task)
+    {
+        int index = currentWorkerIndex();
+        if (index < 0)
+        {
+            submit(std::move(task), TaskPriority::Normal);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        wakeWorkers(1);
+    }
+
+    /// 以指定的優先權提交任務：一律放入全域佇列，讓所有工作執行緒依優先權取出
+    void submit(Task task, TaskPriority priority)
+    {
+        {
+            std::lock_guard<std::mutex> lock(globalMutex_);
+            globalQueues_[static_cast<int>(priority)].push_back(QueuedTask{ std::move(task), Clock::now() });
+        }
+        queued_.fetch_add(1);
+        wakeWorkers(1);
+    }
+
+    /// 一次提交 [first, last) 中的所有任務（元素會被移出）：只取得一次佇列的鎖、只更新一次 queued_，
+    /// 並依任務數一次喚醒至多同樣多個睡眠中的工作執行緒；放入哪個佇列的規則與 submit(Task) 相同
+    /// 整個區間放入佇列後其他執行緒才看得到，範圍很大時可以分批提交，讓工作執行緒提早開始
+    template<typename Iterator>
+    void submitBulk(Iterator first, Iterator last)
+    {
+        int index = currentWorkerIndex();
+        if (index < 0)
+        {
+            submitBulk(first, last, TaskPriority::Normal);
+            return;
+        }
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            for (; first != last; ++first, ++count)
+                workers_[index]->tasks.emplace_back(std::move(*first));
+        }
+        if (count == 0)
+            return;
+        queued_.fetch_add(count);
+        wakeWorkers(count);
+    }
+
+    /// 以指定的優先權一次提交 [first, last) 中的所有任務；同一批任務共用同一個提交時間
+    template<typename Iterator>
+    void submitBulk(Iterator first, Iterator last, TaskPriority priority)
+    {
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(globalMutex_);
+            Clock::time_point now = Clock::now();
+            std::deque<QueuedTask>& queue = globalQueues_[static_cast<int>(priority)];
+            for (; first != last; ++first, ++count)
+                queue.push_back(QueuedTask{ Task(std::move(*first)), now });
+        }
+        if (count == 0)
+            return;
+        queued_.fetch_add(count);
+        wakeWorkers(count);
+    }
+
+    /// 提交任務並以 std::future 取得結果或例外
+    template<typename Func>
+    auto async(Func&& fn) -> std::future<std::invoke_result_t<std::decay_t<Func>&>>
+    {
+        auto [task, future] = packageTask(std::forward<Func>(fn));
+        submit(std::move(task));
+        return std::move(future);
+    }
+
+    /// 以指定的優先權提交任務並以 std::future 取得結果或例外
+    template<typename Func>
+    auto async(Func&& fn, TaskPriority priority) -> std::future<std::invoke_result_t<std::decay_t<Func>&>>
+    {
+        auto [task, future] = packageTask(std::forward<Func>(fn));
+        submit(std::move(task), priority);
+        return std::move(future);
+    }
+
+    /// 若有可執行的任務就執行一個並回傳 true；等待中的執行緒以此「邊等邊做」
+    bool runPendingTask()
+    {
+        Task task;
+        if (!takeTask(currentWorkerIndex(), task))
+            return false;
+        task();
+        return true;
+    }
+
+    /// 目前執行緒在此執行緒池中的工作執行緒編號；不是此執行緒池的工作執行緒則回傳 -1
+    int currentWorkerIndex() const
+    {
+        return currentPool_ == this ? currentIndex_ : -1;
+    }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct QueuedTask
+    {
+        Task task;
+        Clock::time_point enqueueTime;                          // 用於 aging / Used for aging
+    };
+
+    /// 把 fn 包裝成設定 promise 的任務，並回傳對應的 future
+    template<typename Func>
+    static auto packageTask(Func&& fn) -> std::pair<Task, std::future<std::invoke_result_t<std::decay_t<Func>&>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<Func>&>;
+        std::promise<Result> promise;
+        std::future<Result> future = promise.get_future();
+        Task task([promise = std::move(promise), fn = std::forward<Func>(fn)]() mutable
+        {
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    fn();
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(fn());
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return { std::move(task), std::move(future) };
+    }
+
+    /// 依序嘗試：自己的佇列尾端、全域佇列、其他工作執行緒的佇列前端
+    bool takeTask(int index, Task& task)
+    {
+        if (index >= 0)
+        {
+            Worker& self = *workers_[index];
+            std::lock_guard<std::mutex> lock(self.mutex);
+            if (!self.tasks.empty())
+            {
+                task = std::move(self.tasks.back());
+                self.tasks.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(globalMutex_);
+            if (takeGlobalTask(task))
+            {
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        int count = static_cast<int>(workers_.size());
+        for (int k = 1; k <= count; k++)
+        {
+            Worker& victim = *workers_[(index + k + count) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 從全域佇列取出任務（呼叫端須持有 globalMutex_）
+    ///   每個任務的排序鍵為「提交時間 + 優先權等級 × agingInterval」，取出鍵最小的佇列前端（各佇列為 FIFO，前端的鍵最小）
+    ///   因此低一級的任務只要已經等待 agingInterval，就會排在之後才提交的高一級任務前面，不會永遠餓死
+    ///   鍵相同時取較高優先權；只有一個佇列有任務時直接取出
+    bool takeGlobalTask(Task& task)
+    {
+        int chosen = -1;
+        Clock::time_point bestKey;
+        for (int level = 0; level < kNumPriorities; level++)
+        {
+            if (globalQueues_[level].empty())
+                continue;
+            Clock::time_point key = globalQueues_[level].front().enqueueTime + level * agingInterval_;
+            if (chosen < 0 || key < bestKey)
+            {
+                chosen = level;
+                bestKey = key;
+            }
+        }
+        if (chosen < 0)
+            return false;
+        std::deque<QueuedTask>& queue = globalQueues_[chosen];
+        task = std::move(queue.front().task);
+        queue.pop_front();
+        return true;
+    }
+
+    void workerLoop(int index)
+    {
+        currentPool_ = this;
+        currentIndex_ = index;
+        Task task;
+        for (;;)
+        {
+            if (takeTask(index, task))
+            {
+                task();
+                task = Task();                                  // 立即釋放閉包捕捉的資源
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1);
+            sleepCv_.wait(lock, [this] { return queued_.load() > 0 || stopping_; });
+            sleepers_.fetch_sub(1);
+            if (stopping_ && queued_.load() <= 0)
+                return;
+        }
+    }
+
+    /// 喚醒最多 count 個睡眠中的工作執行緒
+    void wakeWorkers(int count)
+    {
+        int sleeping = sleepers_.load();
+        if (sleeping == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);      // 確保睡眠端不在檢查條件與進入等待之間
+        }
+        if (count >= sleeping)
+            sleepCv_.notify_all();
+        else
+        {
+            for (int i = 0; i < count; i++)
+                sleepCv_.notify_one();
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex globalMutex_;
+    std::array<std::deque<QueuedTask>, kNumPriorities> globalQueues_;   // 依 TaskPriority 索引 / Indexed by TaskPriority
+    Clock::duration agingInterval_;
+    alignas(64) std::atomic<int> queued_{ 0 };                 // 已提交但尚未被取走的任務數
+    alignas(64) std::atomic<int> sleepers_{ 0 };
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    static inline thread_local ThreadPool* currentPool_ = nullptr;
+    static inline thread_local int currentIndex_ = -1;
+};
+
+//===================================================================
+// 任務群組 / Task Group
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 一組提交到執行緒池的任務，wait() 等待全部完成
+///   wait 期間先「邊等邊做」執行池中的任務；沒有可執行的任務時才以 std::atomic::wait 睡眠，
+///   因此在工作執行緒內巢狀等待也不會把執行緒池卡死
+///   第一個丟出的例外會被保存，並在 wait() 中重新丟出
+/// Group of pool tasks with a helping wait() and first-exception propagation.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+
+    ~TaskGroup()
+    {
+        waitForTasks();                                         // 任務仍參照此物件，必須等它們結束
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template<typename Func>
+    void run(Func&& fn)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit([this, fn = std::forward<Func>(fn)]() mutable
+        {
+            try
+            {
+                fn();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                if (!error_)
+                    error_ = std::current_exception();
+            }
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pending_.notify_all();
+        });
+    }
+
+    /// 等待所有任務完成；若有任務丟出例外則重新丟出第一個
+    void wait()
+    {
+        waitForTasks();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            error = std::exchange(error_, nullptr);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    void waitForTasks()
+    {
+        for (;;)
+        {
+            int left = pending_.load(std::memory_order_acquire);
+            if (left == 0)
+                return;
+            if (!pool_.runPendingTask())
+                pending_.wait(left, std::memory_order_acquire);
+        }
+    }
+
+    ThreadPool& pool_;
+    std::atomic<int> pending_{ 0 };
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+};
+
+//===================================================================
+// 資料平行演算法 / Data-parallel Algorithms
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 半開區間 [begin, end)
+struct BlockedRange
+{
+    std::size_t begin;
+    std::size_t end;
+
+    std::size_t size() const { return end - begin; }
+};
+
+/// -----------------------------------------------------------------
+/// 自動切割的粒度：讓每個執行緒平均分到約 8 塊，以便負載不均時能互相竊取
+inline std::size_t autoGrain(const ThreadPool& pool, const BlockedRange& range)
+{
+    std::size_t chunks = static_cast<std::size_t>(pool.size() + 1) * 8;
+    return std::max<std::size_t>(1, range.size() / chunks);
+}
+
+/// -----------------------------------------------------------------
+/// parallel_for 的遞迴切割：區間大於 grain 時，把右半部交給執行緒池，自己繼續切左半部，
+/// 直到剩下不超過 grain 的區塊才呼叫 fn；被竊取的右半部會在竊取者那裡繼續切割
+template<typename Func>
+struct ParallelForLoop
+{
+    TaskGroup& group;
+    std::size_t grain;
+    const Func& fn;
+
+    void run(BlockedRange range) const
+    {
+        while (range.size() > grain)
+        {
+            std::size_t middle = range.begin + range.size() / 2;
+            group.run([this, right = BlockedRange{ middle, range.end }] { run(right); });
+            range.end = middle;
+        }
+        fn(range);
+    }
+};
+
+/// -----------------------------------------------------------------
+/// 對 range 平行呼叫 fn(const BlockedRange&)；grain 為 0 時自動決定粒度
+/// 呼叫端會一起執行任務，直到整個區間完成；fn 丟出的例外會在此重新丟出
+/// Parallel loop over a range with recursive splitting.
+template<typename Func>
+void parallel_for(ThreadPool& pool, BlockedRange range, std::size_t grain, const Func& fn)
+{
+    if (range.size() == 0)
+        return;
+    if (grain == 0)
+        grain = autoGrain(pool, range);
+    TaskGroup group(pool);
+    ParallelForLoop<Func> loop{ group, grain, fn };
+    try
+    {
+        loop.run(range);
+    }
+    catch (...)
+    {
+        group.wait();                                           // 先等已提交的區塊結束，再傳遞例外
+        throw;
+    }
+    group.wait();
+}
+
+/// -----------------------------------------------------------------
+/// parallel_reduce 的遞迴切割：右半部交給執行緒池，左半部自己算，等右半部完成後合併
+/// 每一層以 combine(left, right) 依區間順序合併，因此 combine 只需滿足結合律
+template<typename T, typename RangeFunc, typename Combine>
+struct ParallelReducer
+{
+    ThreadPool& pool;
+    std::size_t grain;
+    const T& identity;
+    const RangeFunc& rangeFn;
+    const Combine& combine;
+
+    T reduce(BlockedRange range) const
+    {
+        if (range.size() <= grain)
+            return rangeFn(range, identity);
+        std::size_t middle = range.begin + range.size() / 2;
+        T right = identity;
+        TaskGroup group(pool);
+        group.run([this, &right, middle, end = range.end] { right = reduce(BlockedRange{ middle, end }); });
+        T left = reduce(BlockedRange{ range.begin, middle });
+        group.wait();
+        return combine(left, right);
+    }
+};
+
+/// -----------------------------------------------------------------
+/// 平行歸約：rangeFn(const BlockedRange&, const T& init) 回傳區塊的部分結果，combine 合併兩個部分結果
+/// grain 為 0 時自動決定粒度
+/// Parallel reduction with recursive splitting.
+template<typename T, typename RangeFunc, typename Combine>
+T parallel_reduce(ThreadPool& pool, BlockedRange range, std::size_t grain, T identity,
+                  const RangeFunc& rangeFn, const Combine& combine)
+{
+    if (range.size() == 0)
+        return identity;
+    if (grain == 0)
+        grain = autoGrain(pool, range);
+    ParallelReducer<T, RangeFunc, Combine> reducer{ pool, grain, identity, rangeFn, combine };
+    return reducer.reduce(range);
+}
+
+//===================================================================
+// 任務圖執行器 / Task Graph (DAG) Executor
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 以相依關係描述的任務圖
+///   addNode(fn, dependencies)：新增節點，相依的節點必須已經存在，因此任務圖必定無環
+///   run()：每個節點以原子計數記錄尚未完成的前驅數；前驅全部完成的節點立即交給執行緒池，
+///          同一個節點完成時若有多個後繼就緒，其中一個直接在目前執行緒接著執行，其餘以 submitBulk 一次提交到執行緒池
+///   回傳的 future 在所有節點結束後就緒；任一節點丟出例外時，之後尚未開始的節點都會略過，
+///   第一個例外經由 future 傳回
+/// 同一個任務圖可以重複 run()，但必須等上一次的 future 就緒；執行期間不得修改或解構任務圖
+/// Task graph whose nodes run on the pool as soon as all their predecessors finish.
+class TaskGraph
+{
+public:
+    using NodeId = std::size_t;
+
+    explicit TaskGraph(ThreadPool& pool) : pool_(pool) {}
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    template<typename Func>
+    NodeId addNode(Func&& fn, const std::vector<NodeId>& dependencies = {})
+    {
+        // 先檢查所有相依節點，再動到圖：無效的 id 不能讓前面的節點留下指向已釋放節點的指標
+        for (NodeId dependency : dependencies)
+        {
+            if (dependency >= nodes_.size())
+                throw std::out_of_range("TaskGraph::addNode: unknown dependency id");
+        }
+
+        auto node = std::make_unique<Node>();
+        node->work = std::forward<Func>(fn);
+        node->predecessorCount = static_cast<int>(dependencies.size());
+        Node* added = node.get();
+        nodes_.push_back(std::move(node));
+
+        // 連結途中配置失敗時，撤銷已加入的後繼指標與節點本身
+        std::size_t linked = 0;
+        try
+        {
+            for (; linked < dependencies.size(); ++linked)
+                nodes_[dependencies[linked]]->successors.push_back(added);
+        }
+        catch (...)
+        {
+            while (linked > 0)
+                nodes_[dependencies[--linked]]->successors.pop_back();
+            nodes_.pop_back();
+            throw;
+        }
+        return nodes_.size() - 1;
+    }
+
+    std::size_t size() const { return nodes_.size(); }
+
+    std::future<void> run()
+    {
+        promise_ = std::promise<void>();
+        std::future<void> done = promise_.get_future();
+        failed_.store(false, std::memory_order_relaxed);
+        error_ = nullptr;
+        if (nodes_.empty())
+        {
+            promise_.set_value();
+            return done;
+        }
+        outstanding_.store(nodes_.size(), std::memory_order_relaxed);
+        for (auto& node : nodes_)
+            node->remaining.store(node->predecessorCount, std::memory_order_relaxed);
+        for (auto& node : nodes_)                               // 先收集根節點：提交後其他節點可能立刻開始執行
+        {
+            if (node->predecessorCount == 0)
+            {
+                Node* root = node.get();
+                roots_.emplace_back([this, root] { execute(root); });
+            }
+        }
+        pool_.submitBulk(roots_.begin(), roots_.end());         // 一次提交所有根節點
+        roots_.clear();
+        return done;
+    }
+
+private:
+    struct Node
+    {
+        UniqueFunction<void()> work;
+        std::vector<Node*> successors;
+        int predecessorCount = 0;
+        std::atomic<int> remaining{ 0 };                        // 本次執行中尚未完成的前驅數
+    };
+
+    void execute(Node* node)
+    {
+        while (node != nullptr)
+        {
+            if (!failed_.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    node->work();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex_);
+                    if (!error_)
+                        error_ = std::current_exception();
+                    failed_.store(true, std::memory_order_relaxed);
+                }
+            }
+            // 其餘就緒的後繼收集起來一次提交；node->work() 內的巢狀 execute 只會在此清單為空時使用它
+            static thread_local std::vector<Task> ready;
+            Node* next = nullptr;
+            for (Node* successor : node->successors)
+            {
+                if (successor->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    if (next != nullptr)
+                        ready.emplace_back([this, next] { execute(next); });
+                    next = successor;                           // 最後一個就緒的後繼留在目前執行緒執行
+                }
+            }
+            if (!ready.empty())
+            {
+                pool_.submitBulk(ready.begin(), ready.end());
+                ready.clear();
+            }
+            finishNode();
+            node = next;
+        }
+    }
+
+    /// 最後一個節點結束時設定 future；之後不再存取任何成員，因為呼叫端可能已經解構任務圖
+    void finishNode()
+    {
+        if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        std::promise<void> done = std::move(promise_);
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            error = std::exchange(error_, nullptr);
+        }
+        if (error)
+            done.set_exception(error);
+        else
+            done.set_value();
+    }
+
+    ThreadPool& pool_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::vector<Task> roots_;                                  // run() 中暫存根節點的任務，重複使用以免每次配置
+    std::atomic<std::size_t> outstanding_{ 0 };                // 本次執行中尚未結束的節點數
+    std::atomic<bool> failed_{ false };
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+    std::promise<void> promise_;
+};
+
+//===================================================================
+// 結構化並行範圍 / Structured Concurrency Scope
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 可被取消的睡眠：睡滿 duration 回傳 true；等待期間 token 被要求停止則立即醒來並回傳 false
+/// 以 C++20 condition_variable_any 的 stop_token 多載實作，停止要求會透過 stop_callback 喚醒等待
+/// Sleep that wakes up early when a stop is requested.
+template<typename Rep, typename Period>
+bool interruptibleSleep(std::stop_token token, std::chrono::duration<Rep, Period> duration)
+{
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, token, duration, [] { return false; });
+    return !token.stop_requested();
+}
+
+/// -----------------------------------------------------------------
+/// TaskScope::join() 丟出的例外：保存所有子任務的例外，what() 顯示失敗數與第一個例外的訊息
+class TaskScopeError : public std::runtime_error
+{
+public:
+    explicit TaskScopeError(std::vector<std::exception_ptr> errors)
+        : std::runtime_error(describe(errors)), errors_(std::move(errors)) {}
+
+    const std::vector<std::exception_ptr>& errors() const { return errors_; }
+
+private:
+    static std::string describe(const std::vector<std::exception_ptr>& errors)
+    {
+        std::string first = "unknown exception";
+        try
+        {
+            std::rethrow_exception(errors.front());
+        }
+        catch (const std::exception& e)
+        {
+            first = e.what();
+        }
+        catch (...)
+        {
+        }
+        return std::to_string(errors.size()) + " task(s) failed, first: " + first;
+    }
+
+    std::vector<std::exception_ptr> errors_;
+};
+
+/// -----------------------------------------------------------------
+/// 結構化並行的任務範圍（nursery）：子任務的生命週期不會超出建立它們的範圍
+///   spawn(fn)：以 std::jthread 執行子任務；fn 可以接受 std::stop_token，取得整個範圍共用的停止權杖
+///   任一子任務丟出例外：保存例外，並要求所有兄弟任務停止
+///   join()   ：等待所有子任務結束，若有例外則丟出彙整所有例外的 TaskScopeError
+///   解構子   ：自動 join，不再需要手動管理 join / detach；若因例外離開範圍則先要求停止；
+///             解構子不能丟出例外，未以 join() 取得的例外會被捨棄
+/// 子任務使用獨立的執行緒而不是執行緒池：它們通常是長時間睡眠的迴圈，放在池中會佔住工作執行緒
+/// Structured concurrency scope: joins children on exit and cancels siblings on first failure.
+class TaskScope
+{
+public:
+    TaskScope() : uncaughtOnEntry_(std::uncaught_exceptions()) {}
+
+    ~TaskScope()
+    {
+        if (std::uncaught_exceptions() > uncaughtOnEntry_)
+            requestStop();                                      // 父範圍因例外離開：取消子任務
+        joinAll();
+    }
+
+    TaskScope(const TaskScope&) = delete;
+    TaskScope& operator=(const TaskScope&) = delete;
+
+    template<typename Func>
+    void spawn(Func&& fn)
+    {
+        children_.emplace_back([this, fn = std::forward<Func>(fn)]() mutable
+        {
+            try
+            {
+                if constexpr (std::is_invocable_v<Func&, std::stop_token>)
+                    fn(stopSource_.get_token());
+                else
+                    fn();
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex_);
+                    errors_.push_back(std::current_exception());
+                }
+                stopSource_.request_stop();                     // 第一個失敗就取消所有兄弟任務
+            }
+        });
+    }
+
+    std::stop_token token() const { return stopSource_.get_token(); }
+
+    void requestStop() { stopSource_.request_stop(); }
+
+    void join()
+    {
+        joinAll();
+        std::vector<std::exception_ptr> errors;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            errors.swap(errors_);
+        }
+        if (!errors.empty())
+            throw TaskScopeError(std::move(errors));
+    }
+
+private:
+    void joinAll()
+    {
+        for (auto &child : children_)
+        {
+            if (child.joinable())
+                child.join();
+        }
+        children_.clear();
+    }
+
+    std::stop_source stopSource_;
+    std::mutex errorMutex_;
+    std::vector<std::exception_ptr> errors_;
+    int uncaughtOnEntry_;
+    std::vector<std::jthread> children_;                       // 最後宣告：最先解構，執行緒結束前其他成員都仍有效
+};
+
+//===================================================================
+// 可取消的非同步任務與期限 / Cancellable Async Tasks with Deadlines
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 任務被取消或超過期限時，經由 future 傳回的例外
+class TaskCancelled : public std::runtime_error
+{
+public:
+    TaskCancelled()
+        : std::runtime_error("Task cancelled or deadline expired")
+    {
+    }
+};
+
+/// -----------------------------------------------------------------
+/// 期限計時器：一條背景執行緒，在每個期限到達時對對應的 stop_source 要求停止
+///   期限依時間排序存放在 std::map 中；背景執行緒睡到最早的期限，新的期限比目前最早的還早時才喚醒它
+///   schedule() 回傳的 Id 可以交給 cancel()，任務提早完成時移除期限，不留下過期的項目
+///   request_stop 在鎖外呼叫：它會同步執行 stop_callback（例如喚醒 interruptibleSleep）
+/// Single background thread that requests stop on a stop_source when its deadline passes.
+class DeadlineTimer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Id = std::pair<Clock::time_point, std::uint64_t>;
+
+    DeadlineTimer()
+        : thread_([this](std::stop_token token) { timerLoop(token); })
+    {
+    }
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    /// 在 deadline 對 source 要求停止
+    Id schedule(Clock::time_point deadline, std::stop_source source)
+    {
+        bool earliest;
+        Id id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            id = Id(deadline, nextSequence_++);
+            auto it = timers_.emplace(id, std::move(source)).first;
+            earliest = (it == timers_.begin());
+        }
+        if (earliest)
+            cv_.notify_one();
+        return id;
+    }
+
+    /// 移除尚未到期的期限；已經觸發或已經移除時不做任何事
+    void cancel(const Id& id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.erase(id);
+    }
+
+private:
+    void timerLoop(std::stop_token token)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!token.stop_requested())
+        {
+            if (timers_.empty())
+            {
+                cv_.wait(lock, token, [this] { return !timers_.empty(); });
+                continue;
+            }
+            auto next = timers_.begin();
+            Clock::time_point deadline = next->first.first;
+            if (deadline <= Clock::now())
+            {
+                std::stop_source expired = std::move(next->second);
+                timers_.erase(next);
+                lock.unlock();
+                expired.request_stop();
+                lock.lock();
+                continue;
+            }
+            cv_.wait_until(lock, token, deadline, [this, deadline]
+            {
+                return timers_.empty() || timers_.begin()->first.first < deadline;
+            });
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable_any cv_;
+    std::map<Id, std::stop_source> timers_;
+    std::uint64_t nextSequence_ = 0;
+    std::jthread thread_;                                       // 最後宣告：最先解構（要求停止並 join）
+};
+
+/// -----------------------------------------------------------------
+/// 可取消的 future：擁有任務的 stop_source；cancel() 要求任務停止，get() 取得結果，任務被取消時丟出 TaskCancelled
+template<typename R>
+class CancellableFuture
+{
+public:
+    explicit CancellableFuture(std::future<R> future)
+        : future_(std::move(future))
+    {
+    }
+
+    void cancel() { stopSource_.request_stop(); }
+    std::stop_source stopSource() const { return stopSource_; }
+    R get() { return future_.get(); }
+    void wait() const { future_.wait(); }
+
+    template<typename Rep, typename Period>
+    std::future_status wait_for(std::chrono::duration<Rep, Period> duration) const
+    {
+        return future_.wait_for(duration);
+    }
+
+private:
+    std::future<R> future_;
+    std::stop_source stopSource_;
+};
+
+/// -----------------------------------------------------------------
+/// 在執行緒池上執行 fn(std::stop_token)，timeout 後自動要求停止
+///   協作式取消：fn 應以 interruptibleSleep 睡眠、以 condition_variable_any::wait(lock, token, pred) 等待，
+///   或定期檢查 token，停止要求會讓它提早醒來並返回，工作執行緒隨即可以執行其他任務
+///   開始執行前已被取消的任務不會呼叫 fn；停止要求之後才產生的結果會被捨棄，future 一律丟出 TaskCancelled
+///   任務在設定 promise 之前先移除自己的期限，因此 get() 返回後即可解構計時器
+/// Run fn(std::stop_token) on the pool with a deadline; the future throws TaskCancelled on timeout or cancel().
+template<typename Func, typename Rep, typename Period>
+auto asyncWithDeadline(ThreadPool& pool, DeadlineTimer& timer, std::chrono::duration<Rep, Period> timeout, Func&& fn)
+    -> CancellableFuture<std::invoke_result_t<std::decay_t<Func>&, std::stop_token>>
+{
+    using Result = std::invoke_result_t<std::decay_t<Func>&, std::stop_token>;
+    std::promise<Result> promise;
+    CancellableFuture<Result> future(promise.get_future());
+    std::stop_source source = future.stopSource();
+    DeadlineTimer::Id timerId = timer.schedule(DeadlineTimer::Clock::now() + timeout, source);
+    pool.submit([promise = std::move(promise), fn = std::forward<Func>(fn), token = source.get_token(), &timer, timerId]() mutable
+    {
+        try
+        {
+            if (token.stop_requested())
+                throw TaskCancelled();
+            if constexpr (std::is_void_v<Result>)
+            {
+                fn(token);
+                timer.cancel(timerId);
+                if (token.stop_requested())
+                    throw TaskCancelled();
+                promise.set_value();
+            }
+            else
+            {
+                Result result = fn(token);
+                timer.cancel(timerId);
+                if (token.stop_requested())
+                    throw TaskCancelled();
+                promise.set_value(std::move(result));
+            }
+        }
+        catch (...)
+        {
+            timer.cancel(timerId);
+            promise.set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+//===================================================================
+// 效能測試 / Performance Tests
+//===================================================================
+
+/// -----------------------------------------------------------------
+/// 對照組：與 Lesson 1 Step 3 相同，每次呼叫都建立 numThreads 個執行緒，各自處理固定的一段
+template<typename Func>
+void spawnThreadsFor(int numThreads, BlockedRange range, const Func& fn)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    std::size_t chunk = (range.size() + numThreads - 1) / numThreads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        std::size_t begin = std::min(range.end, range.begin + chunk * t);
+        std::size_t end = std::min(range.end, begin + chunk);
+        threads.emplace_back([&fn, begin, end] { fn(BlockedRange{ begin, end }); });
+    }
+    for (auto &th : threads)
+         th.join();
+}
+
+/// -----------------------------------------------------------------
+/// 測試加總大型 std::vector<int>（類似 Lesson 2 的資料向量），重複 repeats 次
+///   mode = 0：單執行緒迴圈
+///   mode = 1：每次建立 numThreads 個執行緒（Lesson 1 Step 3 的做法）
+///   mode = 2：parallel_reduce，使用 numThreads 個工作執行緒的執行緒池（建立在計時範圍外，重複使用）
+/// Summing a large vector: serial loop, threads spawned per call, or parallel_reduce on a pool.
+double testParallelSumPerformance(int numThreads, int dataSize, int repeats, int mode)
+{
+    std::vector<int> data(dataSize);
+    for (int i = 0; i < dataSize; i++)
+        data[i] = i % 1000;
+    long long expected = 0;
+    for (int value : data)
+        expected += value;
+
+    std::unique_ptr<ThreadPool> pool;
+    if (mode == 2)
+        pool = std::make_unique<ThreadPool>(numThreads);
+    auto sumRange = [&data](const BlockedRange& range, long long init)
+    {
+        long long sum = init;
+        for (std::size_t i = range.begin; i < range.end; i++)
+            sum += data[i];
+        return sum;
+    };
+
+    bool correct = true;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; r++)
+    {
+        long long total = 0;
+        BlockedRange all{ 0, data.size() };
+        if (mode == 0)
+            total = sumRange(all, 0);
+        else if (mode == 1)
+        {
+            std::vector<long long> partial(numThreads, 0);
+            std::size_t chunk = (all.size() + numThreads - 1) / numThreads;
+            spawnThreadsFor(numThreads, all, [&](const BlockedRange& range)
+            {
+                partial[range.begin / std::max<std::size_t>(chunk, 1)] = sumRange(range, 0);
+            });
+            for (long long value : partial)
+                total += value;
+        }
+        else
+            total = parallel_reduce(*pool, all, 0, 0LL, sumRange, [](long long a, long long b) { return a + b; });
+        correct = correct && total == expected;
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (!correct)
+        std::cout << "[testParallelSumPerformance] Wrong sum!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試就地轉換大型 std::vector<int>（每個元素 value = (value * 7 + 3) % 1000），重複 repeats 次
+///   mode 與 testParallelSumPerformance 相同，mode = 2 使用 parallel_for
+/// Transforming a large vector in place: serial loop, threads spawned per call, or parallel_for on a pool.
+double testParallelTransformPerformance(int numThreads, int dataSize, int repeats, int mode)
+{
+    std::vector<int> data(dataSize);
+    for (int i = 0; i < dataSize; i++)
+        data[i] = i % 1000;
+    std::vector<int> expected = data;
+    for (int r = 0; r < repeats; r++)
+    {
+        for (int& value : expected)
+            value = (value * 7 + 3) % 1000;
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (mode == 2)
+        pool = std::make_unique<ThreadPool>(numThreads);
+    auto transformRange = [&data](const BlockedRange& range)
+    {
+        for (std::size_t i = range.begin; i < range.end; i++)
+            data[i] = (data[i] * 7 + 3) % 1000;
+    };
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; r++)
+    {
+        BlockedRange all{ 0, data.size() };
+        if (mode == 0)
+            transformRange(all);
+        else if (mode == 1)
+            spawnThreadsFor(numThreads, all, transformRange);
+        else
+            parallel_for(*pool, all, 0, transformRange);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (data != expected)
+        std::cout << "[testParallelTransformPerformance] Wrong result!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試任務圖每個節點的排程成本（節點本身只遞增一個計數器）
+///   deep = false：寬圖，1 個根節點 → numNodes - 2 個彼此獨立的節點 → 1 個匯合節點
+///   deep = true ：深圖，numNodes 個節點串成一條鏈
+///   任務圖只建立一次，在計時範圍內重複 run() runs 次
+/// Per-node scheduling overhead of TaskGraph for wide and deep DAGs.
+double testTaskGraphPerformance(int numThreads, bool deep, int numNodes, int runs)
+{
+    ThreadPool pool(numThreads);
+    TaskGraph graph(pool);
+    std::atomic<long long> executed(0);
+    auto work = [&executed] { executed.fetch_add(1, std::memory_order_relaxed); };
+    if (deep)
+    {
+        TaskGraph::NodeId previous = graph.addNode(work);
+        for (int i = 1; i < numNodes; i++)
+            previous = graph.addNode(work, { previous });
+    }
+    else
+    {
+        TaskGraph::NodeId root = graph.addNode(work);
+        std::vector<TaskGraph::NodeId> middle;
+        for (int i = 0; i < numNodes - 2; i++)
+            middle.push_back(graph.addNode(work, { root }));
+        graph.addNode(work, middle);
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < runs; r++)
+        graph.run().get();
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (executed.load() != static_cast<long long>(numNodes) * runs)
+        std::cout << "[testTaskGraphPerformance] Lost nodes!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試取消延遲：numChildren 個 helperTask 形式的迴圈（每輪睡 sleepMillis 毫秒），約 20 毫秒後另一個子任務失敗
+///   useScope = true ：TaskScope + interruptibleSleep，失敗會要求停止，睡眠中的迴圈立即醒來
+///   useScope = false：std::thread + 原子旗標 + sleep_for，失敗時設定旗標，迴圈要睡滿這一輪才看得到
+/// 回傳從子任務失敗到所有子任務都已 join 的時間（秒）
+/// Cancellation latency: from a child's failure until every sibling has been joined.
+double testCancellationLatency(int numChildren, int sleepMillis, bool useScope)
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point failTime;
+    Clock::time_point joinedTime;
+    auto failAfterDelay = [&failTime]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        failTime = Clock::now();
+        throw std::runtime_error("Child task failed");
+    };
+
+    if (useScope)
+    {
+        TaskScope scope;
+        for (int i = 0; i < numChildren; i++)
+        {
+            scope.spawn([sleepMillis](std::stop_token token)
+            {
+                while (interruptibleSleep(token, std::chrono::milliseconds(sleepMillis)))
+                    { }
+            });
+        }
+        scope.spawn(failAfterDelay);
+        try
+        {
+            scope.join();
+        }
+        catch (const TaskScopeError&)
+        {
+        }
+        joinedTime = Clock::now();
+    }
+    else
+    {
+        std::atomic<bool> stopFlag(false);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numChildren; i++)
+        {
+            threads.emplace_back([&stopFlag, sleepMillis]
+            {
+                while (!stopFlag.load())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMillis));
+            });
+        }
+        threads.emplace_back([&]
+        {
+            try
+            {
+                failAfterDelay();
+            }
+            catch (...)
+            {
+                stopFlag = true;
+            }
+        });
+        for (auto &th : threads)
+             th.join();
+        joinedTime = Clock::now();
+    }
+    return std::chrono::duration<double>(joinedTime - failTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試釋放延遲：numTasks 個與 Lesson 1 asyncTask 相同、睡眠 150 毫秒的任務，期限為 20 毫秒
+///   useDeadline = true ：asyncWithDeadline + interruptibleSleep，期限一到任務就醒來並釋放工作執行緒
+///   useDeadline = false：與 Step 8 相同的 std::async，呼叫端 wait_for 逾時後只能放棄等待，執行緒要等任務睡完才釋放
+/// 回傳從期限到任務實際結束（執行緒可再利用）的平均時間（秒）
+/// Release latency: average time from a task's deadline until its thread is actually free again.
+double testDeadlineReleaseLatency(int numTasks, bool useDeadline)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto taskDuration = std::chrono::milliseconds(150);
+    const auto timeout = std::chrono::milliseconds(20);
+    std::vector<Clock::time_point> deadlines(numTasks);
+    std::vector<Clock::time_point> releaseTimes(numTasks);
+
+    if (useDeadline)
+    {
+        ThreadPool pool(numTasks);
+        DeadlineTimer timer;
+        std::vector<CancellableFuture<int>> futures;
+        futures.reserve(numTasks);
+        for (int i = 0; i < numTasks; i++)
+        {
+            deadlines[i] = Clock::now() + timeout;
+            futures.push_back(asyncWithDeadline(pool, timer, timeout, [&releaseTimes, i, taskDuration](std::stop_token token)
+            {
+                interruptibleSleep(token, taskDuration);
+                releaseTimes[i] = Clock::now();
+                return 10 + 20;
+            }));
+        }
+        for (auto &future : futures)
+        {
+            try
+            {
+                future.get();
+            }
+            catch (const TaskCancelled&)
+            {
+            }
+        }
+    }
+    else
+    {
+        std::vector<std::future<int>> futures;
+        futures.reserve(numTasks);
+        for (int i = 0; i < numTasks; i++)
+        {
+            deadlines[i] = Clock::now() + timeout;
+            futures.push_back(std::async(std::launch::async, [&releaseTimes, i, taskDuration]
+            {
+                std::this_thread::sleep_for(taskDuration);
+                releaseTimes[i] = Clock::now();
+                return 10 + 20;
+            }));
+        }
+        for (int i = 0; i < numTasks; i++)
+            futures[i].wait_until(deadlines[i]);                // 逾時後放棄等待，但任務仍佔用執行緒
+        for (auto &future : futures)
+             future.wait();
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < numTasks; i++)
+        total += std::chrono::duration<double>(releaseTimes[i] - deadlines[i]).count();
+    return total / numTasks;
+}
+
+/// -----------------------------------------------------------------
+/// 測試逾時比例 10% 時的吞吐量：numJobs 個工作，每 10 個中有 1 個需要 100 毫秒（會逾時），其餘 1 毫秒，期限 20 毫秒
+///   呼叫端最多同時保留 2 * numThreads 個未完成的工作，依序等待最舊的一個（模擬有上限的請求者）
+///   useDeadline = true ：asyncWithDeadline + interruptibleSleep，逾時的工作在期限時就釋放工作執行緒
+///   useDeadline = false：pool.async + sleep_for，呼叫端以 wait_for 逾時放棄，但工作執行緒仍被佔用到工作結束
+/// 回傳總時間（秒，包含等待所有工作執行緒真正空出來），timedOut 回傳逾時的工作數
+/// Throughput with a 10% timeout rate, with and without cooperative cancellation.
+double testDeadlineThroughput(int numThreads, int numJobs, bool useDeadline, int& timedOut)
+{
+    const auto fastJob = std::chrono::milliseconds(1);
+    const auto slowJob = std::chrono::milliseconds(100);
+    const auto timeout = std::chrono::milliseconds(20);
+    const std::size_t window = 2 * static_cast<std::size_t>(numThreads);
+    timedOut = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool(numThreads);
+        DeadlineTimer timer;
+        if (useDeadline)
+        {
+            std::deque<CancellableFuture<void>> pending;
+            auto waitOldest = [&]
+            {
+                try
+                {
+                    pending.front().get();
+                }
+                catch (const TaskCancelled&)
+                {
+                    timedOut++;
+                }
+                pending.pop_front();
+            };
+            for (int i = 0; i < numJobs; i++)
+            {
+                if (pending.size() == window)
+                    waitOldest();
+                auto duration = (i % 10 == 9) ? slowJob : fastJob;
+                pending.push_back(asyncWithDeadline(pool, timer, timeout, [duration](std::stop_token token)
+                {
+                    interruptibleSleep(token, duration);
+                }));
+            }
+            while (!pending.empty())
+                waitOldest();
+        }
+        else
+        {
+            using Clock = std::chrono::steady_clock;
+            std::deque<std::pair<std::future<void>, Clock::time_point>> pending;
+            auto waitOldest = [&]
+            {
+                if (pending.front().first.wait_until(pending.front().second) == std::future_status::timeout)
+                    timedOut++;
+                pending.pop_front();
+            };
+            for (int i = 0; i < numJobs; i++)
+            {
+                if (pending.size() == window)
+                    waitOldest();
+                auto duration = (i % 10 == 9) ? slowJob : fastJob;
+                pending.emplace_back(pool.async([duration] { std::this_thread::sleep_for(duration); }), Clock::now() + timeout);
+            }
+            while (!pending.empty())
+                waitOldest();
+        }
+    }   // 解構執行緒池：等待所有仍佔用工作執行緒的工作結束
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+/// -----------------------------------------------------------------
+/// 測試高優先權任務的延遲：先提交 numBatchJobs 個長時間的批次工作（每個計算 batchIterations 次），
+/// 再每隔 highInterval 提交一個與 Lesson 1 basicTask 一樣短的工作，共 numHighJobs 個
+///   usePriority = true ：批次工作為 Low、短工作為 High
+///   usePriority = false：全部以 Normal 提交，等同單一 FIFO 佇列
+///   agingInterval 越短，等待已久的批次工作越早排到新提交的短工作前面
+/// 回傳短工作從提交到開始執行的延遲（秒，已排序）
+/// Latency of short high-priority jobs submitted while long batch jobs occupy the pool.
+std::vector<double> testPriorityLatency(int numThreads, int numBatchJobs, long long batchIterations,
+                                        int numHighJobs, std::chrono::microseconds highInterval, bool usePriority,
+                                        std::chrono::milliseconds agingInterval = std::chrono::milliseconds(50))
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<Clock::time_point> submitTimes(numHighJobs);
+    std::vector<Clock::time_point> startTimes(numHighJobs);
+    std::atomic<long long> batchSink(0);
+    std::atomic<int> basicCount(0);
+    {
+        ThreadPool pool(numThreads, agingInterval);
+        for (int i = 0; i < numBatchJobs; i++)
+        {
+            Task batchJob([&batchSink, batchIterations]
+            {
+                long long sum = 0;
+                for (long long k = 0; k < batchIterations; k++)
+                    sum += k * k;
+                batchSink += sum;
+            });
+            if (usePriority)
+                pool.submit(std::move(batchJob), TaskPriority::Low);
+            else
+                pool.submit(std::move(batchJob));
+        }
+        for (int i = 0; i < numHighJobs; i++)
+        {
+            std::this_thread::sleep_for(highInterval);
+            submitTimes[i] = Clock::now();
+            Task basicJob([&startTimes, &basicCount, i]
+            {
+                startTimes[i] = Clock::now();
+                basicCount++;
+            });
+            if (usePriority)
+                pool.submit(std::move(basicJob), TaskPriority::High);
+            else
+                pool.submit(std::move(basicJob));
+        }
+    }   // 解構執行緒池：等待所有工作完成
+
+    std::vector<double> latencies(numHighJobs);
+    for (int i = 0; i < numHighJobs; i++)
+        latencies[i] = std::chrono::duration<double>(startTimes[i] - submitTimes[i]).count();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+/// -----------------------------------------------------------------
+/// 測試提交成本：numJobs 個與 Lesson 1 basicTask 一樣小的工作（遞增計數器）
+///   batchSize = 1：逐一 submit，每個任務都要取得一次鎖、更新一次 queued_，並可能喚醒一次工作執行緒
+///   batchSize > 1：每 batchSize 個任務以 submitBulk 提交一次
+/// 回傳從開始提交到所有工作完成的時間（秒）
+/// Cost of submitting many tiny jobs one by one versus in batches.
+double testSubmitPerformance(int numThreads, int numJobs, int batchSize)
+{
+    std::atomic<int> counter(0);
+    auto basicJob = [&counter] { counter.fetch_add(1, std::memory_order_relaxed); };
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool(numThreads);
+        if (batchSize <= 1)
+        {
+            for (int i = 0; i < numJobs; i++)
+                pool.submit(basicJob);
+        }
+        else
+        {
+            std::vector<Task> batch;
+            batch.reserve(batchSize);
+            for (int i = 0; i < numJobs; i += batchSize)
+            {
+                int count = std::min(batchSize, numJobs - i);
+                for (int k = 0; k < count; k++)
+                    batch.emplace_back(basicJob);
+                pool.submitBulk(batch.begin(), batch.end());
+                batch.clear();
+            }
+        }
+    }   // 解構執行緒池：等待所有工作完成
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (counter.load() != numJobs)
+        std::cout << "[testSubmitPerformance] Lost jobs!" << std::endl;
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+int main()
+{
+    // 輸出格式設定 / Output formatting settings
+    const int widthLabel = 50;
+    const int widthTime  = 12;
+    std::cout << std::fixed << std::setprecision(6);
+
+    // ------ 執行緒池與 async / Thread Pool and async ------
+    std::cout << "\n=== Thread Pool and async / 執行緒池與 async ===\n\n";
+    {
+        ThreadPool pool(2);
+        std::future<int> sum = pool.async([] { return 10 + 20; });
+        std::future<void> failing = pool.async([] { throw std::runtime_error("Exception from pool task"); });
+        std::cout << "[Main] Result from pool task: " << sum.get() << std::endl;
+        try
+        {
+            failing.get();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "[Main] Caught exception: " << e.what() << std::endl;
+        }
+    }
+
+    // ------ 任務圖 / Task Graph ------
+    // Lesson 1 的步驟依序執行，即使彼此獨立；以任務圖描述相依關係後，獨立的步驟可以同時執行
+    std::cout << "\n=== Task Graph / 任務圖 ===\n\n";
+    {
+        ThreadPool pool(2);
+        TaskGraph graph(pool);
+        int x = 0, y = 0, sum = 0;
+        auto loadX = graph.addNode([&x] { x = 10; });
+        auto loadY = graph.addNode([&y] { y = 20; });
+        graph.addNode([&] { sum = x + y; }, { loadX, loadY });
+        graph.run().get();
+        std::cout << "[Main] Graph result: " << sum << std::endl;
+
+        TaskGraph failingGraph(pool);
+        auto failing = failingGraph.addNode([] { throw std::runtime_error("Exception from graph node"); });
+        failingGraph.addNode([] { std::cout << "[Main] This node should be skipped" << std::endl; }, { failing });
+        try
+        {
+            failingGraph.run().get();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "[Main] Caught exception: " << e.what() << std::endl;
+        }
+    }
+
+    // ------ 結構化並行範圍 / Structured Concurrency Scope ------
+    // Step 5、6 需要手動 join / detach；TaskScope 離開範圍時自動 join，失敗時取消兄弟任務
+    std::cout << "\n=== Structured Concurrency Scope / 結構化並行範圍 ===\n\n";
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        std::atomic<int> helperIterations(0);
+        try
+        {
+            TaskScope scope;
+            for (int i = 0; i < 3; i++)
+            {
+                scope.spawn([&helperIterations](std::stop_token token)
+                {
+                    // 與 Lesson 1 的 helperTask 相同，每 100 毫秒一輪，共 5 輪
+                    for (int iteration = 0; iteration < 5; iteration++)
+                    {
+                        helperIterations++;
+                        if (!interruptibleSleep(token, std::chrono::milliseconds(100)))
+                            return;
+                    }
+                });
+            }
+            scope.spawn([]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(150));
+                throw std::runtime_error("Exception from child task");
+            });
+            scope.join();
+        }
+        catch (const TaskScopeError& e)
+        {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            std::cout << "[Main] Caught TaskScopeError: " << e.what() << std::endl;
+            std::cout << "[Main] Helpers ran " << helperIterations.load() << " of 15 iterations, scope finished after "
+                      << elapsed * 1000 << " ms" << std::endl;
+        }
+    }
+
+    // ------ 可取消的非同步任務 / Cancellable Async Tasks ------
+    // Step 8 的 std::async 無法取消：asyncTask 會佔用執行緒直到睡滿 150 毫秒；加上期限後，期限一到就醒來並釋放
+    std::cout << "\n=== Cancellable Async Tasks / 可取消的非同步任務 ===\n\n";
+    {
+        ThreadPool pool(2);
+        DeadlineTimer timer;
+        auto cancellableAsyncTask = [](int x, int y)
+        {
+            return [x, y](std::stop_token token)
+            {
+                interruptibleSleep(token, std::chrono::milliseconds(150));
+                return x + y;
+            };
+        };
+        auto onTime = asyncWithDeadline(pool, timer, std::chrono::milliseconds(500), cancellableAsyncTask(10, 20));
+        auto tooSlow = asyncWithDeadline(pool, timer, std::chrono::milliseconds(50), cancellableAsyncTask(1, 2));
+        std::cout << "[Main] Result from task with 500 ms deadline: " << onTime.get() << std::endl;
+        auto startTime = std::chrono::steady_clock::now();
+        try
+        {
+            tooSlow.get();
+        }
+        catch (const TaskCancelled& e)
+        {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            std::cout << "[Main] Task with 50 ms deadline: " << e.what() << " (" << elapsed * 1000 << " ms after the first result)" << std::endl;
+        }
+    }
+
+    // ------ 優先權與 aging / Priorities and Aging ------
+    // 只有一個工作執行緒且高優先權任務源源不絕時，低優先權任務（低兩級）仍會在等待約 2 × agingInterval 後被執行
+    std::cout << "\n=== Task Priorities / 任務優先權 ===\n\n";
+    {
+        ThreadPool pool(1, std::chrono::milliseconds(20));
+        std::atomic<int> highDone(0);
+        auto highJob = [&highDone]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            highDone++;
+        };
+        pool.submit(highJob, TaskPriority::High);           // 先讓唯一的工作執行緒忙碌 / Keep the only worker busy
+        auto submitTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lowStart;
+        std::future<int> lowTask = pool.async([&lowStart, &highDone]
+        {
+            lowStart = std::chrono::steady_clock::now();
+            return highDone.load();
+        }, TaskPriority::Low);
+        for (int i = 0; i < 100; i++)
+        {
+            pool.submit(highJob, TaskPriority::High);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        int highBeforeLow = lowTask.get();
+        double waited = std::chrono::duration<double>(lowStart - submitTime).count();
+        std::cout << "[Main] Low-priority task started after " << waited * 1000 << " ms, behind "
+                  << highBeforeLow << " of 101 high-priority tasks (aging interval 20 ms)" << std::endl;
+    }
+
+    // ------ 平行演算法測試 / Parallel Algorithm Tests ------
+    // 大向量：計算量為主；小向量：重複次數多，建立執行緒的成本變得明顯
+    // Large vector: dominated by the work itself. Small vector: many calls, so thread creation cost shows.
+    struct Workload
+    {
+        int dataSize;               // 資料向量大小 / Size of the data vector
+        int repeats;                // 每個測試重複的次數 / Repetitions per test
+    };
+    const Workload workloads[] = { { 10000000, 20 }, { 100000, 2000 } };
+    const int threadCounts[] = { 1, 2, 4, 8 };
+
+    for (const Workload& workload : workloads)
+    {
+        std::string sizeLabel = "dataSize = " + std::to_string(workload.dataSize) + ", repeats = " + std::to_string(workload.repeats);
+        std::cout << "\n=== Parallel Sum Tests / 平行加總測試 (" << sizeLabel << ") ===\n\n";
+        double serialSum = testParallelSumPerformance(1, workload.dataSize, workload.repeats, 0);
+        std::cout << std::setw(widthLabel) << "Serial loop / 單執行緒迴圈:" << std::setw(widthTime) << serialSum << " sec\n\n";
+        for (int numThreads : threadCounts)
+        {
+            double spawnTime = testParallelSumPerformance(numThreads, workload.dataSize, workload.repeats, 1);
+            double poolTime = testParallelSumPerformance(numThreads, workload.dataSize, workload.repeats, 2);
+            std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+            std::cout << std::setw(widthLabel) << label << "\n";
+            std::cout << std::setw(widthLabel) << "  threads spawned per call / 每次建立執行緒:" << std::setw(widthTime) << spawnTime << " sec\n";
+            std::cout << std::setw(widthLabel) << "  parallel_reduce on pool / 執行緒池:" << std::setw(widthTime) << poolTime << " sec\n\n";
+        }
+
+        std::cout << "\n=== Parallel Transform Tests / 平行轉換測試 (" << sizeLabel << ") ===\n\n";
+        double serialTransform = testParallelTransformPerformance(1, workload.dataSize, workload.repeats, 0);
+        std::cout << std::setw(widthLabel) << "Serial loop / 單執行緒迴圈:" << std::setw(widthTime) << serialTransform << " sec\n\n";
+        for (int numThreads : threadCounts)
+        {
+            double spawnTime = testParallelTransformPerformance(numThreads, workload.dataSize, workload.repeats, 1);
+            double poolTime = testParallelTransformPerformance(numThreads, workload.dataSize, workload.repeats, 2);
+            std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+            std::cout << std::setw(widthLabel) << label << "\n";
+            std::cout << std::setw(widthLabel) << "  threads spawned per call / 每次建立執行緒:" << std::setw(widthTime) << spawnTime << " sec\n";
+            std::cout << std::setw(widthLabel) << "  parallel_for on pool / 執行緒池:" << std::setw(widthTime) << poolTime << " sec\n\n";
+        }
+    }
+
+    // ------ 任務圖排程成本測試 / Task Graph Scheduling Tests ------
+    int graphNodes = 10000;         // 每個任務圖的節點數 / Nodes per graph
+    int graphRuns = 20;             // 每個任務圖執行的次數 / Runs per graph
+    std::cout << "\n=== Task Graph Scheduling Tests / 任務圖排程成本測試 ===\n\n";
+    for (int numThreads : threadCounts)
+    {
+        double wideTime = testTaskGraphPerformance(numThreads, false, graphNodes, graphRuns);
+        double deepTime = testTaskGraphPerformance(numThreads, true, graphNodes, graphRuns);
+        double totalNodes = static_cast<double>(graphNodes) * graphRuns;
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  wide DAG / 寬圖:" << std::setw(widthTime) << wideTime << " sec"
+                  << std::setw(widthTime) << wideTime / totalNodes * 1e9 << " ns/node\n";
+        std::cout << std::setw(widthLabel) << "  deep DAG / 深圖:" << std::setw(widthTime) << deepTime << " sec"
+                  << std::setw(widthTime) << deepTime / totalNodes * 1e9 << " ns/node\n\n";
+    }
+
+    // ------ 取消延遲測試 / Cancellation Latency Tests ------
+    int helperSleepMillis = 100;    // helperTask 形式迴圈每輪睡眠的時間 / Sleep per helper iteration
+    const int childCounts[] = { 1, 4, 16, 64 };
+    std::cout << "\n=== Cancellation Latency Tests / 取消延遲測試 ===\n\n";
+    for (int numChildren : childCounts)
+    {
+        double flagLatency = testCancellationLatency(numChildren, helperSleepMillis, false);
+        double scopeLatency = testCancellationLatency(numChildren, helperSleepMillis, true);
+        std::string label = std::to_string(numChildren) + " sleeping child(ren) / " + std::to_string(numChildren) + " 個子任務:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  std::thread + flag + sleep_for:" << std::setw(widthTime) << flagLatency * 1000 << " ms\n";
+        std::cout << std::setw(widthLabel) << "  TaskScope + interruptibleSleep:" << std::setw(widthTime) << scopeLatency * 1000 << " ms\n\n";
+    }
+
+    // ------ 期限與取消測試 / Deadline and Cancellation Tests ------
+    const int releaseTaskCounts[] = { 1, 16, 64 };
+    std::cout << "\n=== Deadline Release Latency Tests / 期限釋放延遲測試 ===\n\n";
+    for (int numTasks : releaseTaskCounts)
+    {
+        double asyncLatency = testDeadlineReleaseLatency(numTasks, false);
+        double deadlineLatency = testDeadlineReleaseLatency(numTasks, true);
+        std::string label = std::to_string(numTasks) + " task(s) / " + std::to_string(numTasks) + " 個任務:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  std::async + wait_for:" << std::setw(widthTime) << asyncLatency * 1000 << " ms\n";
+        std::cout << std::setw(widthLabel) << "  asyncWithDeadline + interruptibleSleep:" << std::setw(widthTime) << deadlineLatency * 1000 << " ms\n\n";
+    }
+
+    int deadlineJobs = 400;         // 每個吞吐量測試的工作數 / Jobs per throughput test
+    const int deadlineThreadCounts[] = { 4, 16 };
+    std::cout << "\n=== Throughput with 10% Timeouts / 逾時比例 10% 的吞吐量 (" << deadlineJobs << " jobs) ===\n\n";
+    for (int numThreads : deadlineThreadCounts)
+    {
+        int asyncTimedOut = 0;
+        int deadlineTimedOut = 0;
+        double asyncTime = testDeadlineThroughput(numThreads, deadlineJobs, false, asyncTimedOut);
+        double deadlineTime = testDeadlineThroughput(numThreads, deadlineJobs, true, deadlineTimedOut);
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  pool.async + wait_for (abandon):" << std::setw(widthTime) << asyncTime << " sec, "
+                  << deadlineJobs / asyncTime << " jobs/sec, " << asyncTimedOut << " timed out\n";
+        std::cout << std::setw(widthLabel) << "  asyncWithDeadline (cancel):" << std::setw(widthTime) << deadlineTime << " sec, "
+                  << deadlineJobs / deadlineTime << " jobs/sec, " << deadlineTimedOut << " timed out\n\n";
+    }
+
+    // ------ 優先權排程測試 / Priority Scheduling Tests ------
+    int batchJobs = 200;                        // 長時間批次工作數 / Number of long batch jobs
+    long long batchIterations = 2000000;        // 每個批次工作的計算量 / Work per batch job
+    int highJobs = 200;                         // 短的高優先權工作數 / Number of short high-priority jobs
+    auto highInterval = std::chrono::microseconds(500);
+    const int priorityThreadCounts[] = { 2, 4, 8 };
+    std::cout << "\n=== Priority Scheduling Tests / 優先權排程測試 (" << batchJobs << " batch jobs, "
+              << highJobs << " short jobs) ===\n\n";
+    for (int numThreads : priorityThreadCounts)
+    {
+        std::vector<double> fifo = testPriorityLatency(numThreads, batchJobs, batchIterations, highJobs, highInterval, false);
+        std::vector<double> prio = testPriorityLatency(numThreads, batchJobs, batchIterations, highJobs, highInterval, true,
+                                                       std::chrono::milliseconds(1000));
+        std::vector<double> aged = testPriorityLatency(numThreads, batchJobs, batchIterations, highJobs, highInterval, true,
+                                                       std::chrono::milliseconds(50));
+        auto percentile = [](const std::vector<double>& sorted, int p) { return sorted[(sorted.size() - 1) * p / 100]; };
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        std::cout << std::setw(widthLabel) << "  Single FIFO queue p50 / p99:" << std::setw(widthTime) << percentile(fifo, 50) * 1000
+                  << " ms / " << percentile(fifo, 99) * 1000 << " ms\n";
+        std::cout << std::setw(widthLabel) << "  Priority queues, aging 1000 ms, p50 / p99:" << std::setw(widthTime) << percentile(prio, 50) * 1000
+                  << " ms / " << percentile(prio, 99) * 1000 << " ms\n";
+        std::cout << std::setw(widthLabel) << "  Priority queues, aging 50 ms, p50 / p99:" << std::setw(widthTime) << percentile(aged, 50) * 1000
+                  << " ms / " << percentile(aged, 99) * 1000 << " ms\n\n";
+    }
+
+    // ------ 批次提交測試 / Bulk Submission Tests ------
+    int submitJobs = 1000000;       // 小工作的數量 / Number of tiny jobs
+    const int batchSizes[] = { 1, 64, 1024 };
+    std::cout << "\n=== Bulk Submission Tests / 批次提交測試 (" << submitJobs << " jobs) ===\n\n";
+    for (int numThreads : threadCounts)
+    {
+        std::string label = std::to_string(numThreads) + " thread(s) / " + std::to_string(numThreads) + " 個執行緒:";
+        std::cout << std::setw(widthLabel) << label << "\n";
+        for (int batchSize : batchSizes)
+        {
+            double elapsed = testSubmitPerformance(numThreads, submitJobs, batchSize);
+            std::string batchLabel = batchSize == 1 ? std::string("  submit one by one / 逐一提交:")
+                                                    : "  submitBulk, batch " + std::to_string(batchSize) + " / 批次提交:";
+            std::cout << std::setw(widthLabel) << batchLabel << std::setw(widthTime) << elapsed << " sec ("
+                      << elapsed * 1e9 / submitJobs << " ns/job)\n";
+        }
+        std::cout << "\n";
+    }
+
+    return 0;   // 程式結束 / End program
+}